@@ -0,0 +1,128 @@
+#ifndef MODULAR_ROBOTICS_BITTENSOR_H
+#define MODULAR_ROBOTICS_BITTENSOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Coord.h"
+
+// Tensor of bits in linear layout (x-axis varying fastest), stored in 64-bit words so that fills work on 64 cells at a
+// time. Replaces CoordTensor<bool>, which goes through std::vector<bool> proxy references for every access.
+class BitTensor {
+private:
+    static constexpr int WORD_BITS = 64;
+
+    int _order = 0;
+    // Length of each axis
+    std::vector<int> _axisSizes;
+    // Number of cells in the tensor
+    int _size = 0;
+    // Index multiplier for each axis, 0 past the order of the tensor
+    std::array<int, COORD_MAX_ORDER> _strides = {};
+    // Index of the origin, non-zero when the tensor was created with an origin offset
+    int _originIndex = 0;
+    std::vector<std::uint64_t> _words;
+
+    // Mask of the bits of the last word that belong to the tensor
+    [[nodiscard]]
+    std::uint64_t TailMask() const {
+        const int tailBits = _size % WORD_BITS;
+        return tailBits == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << tailBits) - 1;
+    }
+
+public:
+    BitTensor() = default;
+
+    // Creates a tensor of the specified order and axis length with every cell set to value, the origin offset works the
+    // same way as it does for CoordTensor
+    BitTensor(const int order, const int axisSize, const bool value = false, const std::vector<int>& originOffset = {})
+            : BitTensor(std::vector<int>(order, axisSize), value, originOffset) {}
+
+    // Creates a tensor whose axes may differ in length, the order is the number of axis sizes given
+    explicit BitTensor(const std::vector<int>& axisSizes, const bool value = false, const std::vector<int>& originOffset = {})
+            : _order(static_cast<int>(axisSizes.size())), _axisSizes(axisSizes) {
+        int multiplier = 1;
+        for (int i = 0; i < _order; i++) {
+            _strides[i] = multiplier;
+            multiplier *= axisSizes[i];
+        }
+        _size = multiplier;
+        for (int i = 0; i < originOffset.size(); i++) {
+            _originIndex += originOffset[i] * _strides[i];
+        }
+        _words.resize((_size + WORD_BITS - 1) / WORD_BITS);
+        Fill(value);
+    }
+
+    [[nodiscard]]
+    int Order() const {
+        return _order;
+    }
+
+    // Get the length of an axis
+    [[nodiscard]]
+    int AxisSize(const int axis) const {
+        return _axisSizes[axis];
+    }
+
+    // Get the number of cells in the tensor
+    [[nodiscard]]
+    int Size() const {
+        return _size;
+    }
+
+    // Get the index of a coordinate
+    [[nodiscard]]
+    int IndexFromCoords(const LatticeCoord& coords) const {
+        return _originIndex + coords[0] * _strides[0] + coords[1] * _strides[1] + coords[2] * _strides[2];
+    }
+
+    // Get the change in index caused by moving by offset
+    [[nodiscard]]
+    int IndexOffset(const LatticeCoord& offset) const {
+        return offset[0] * _strides[0] + offset[1] * _strides[1] + offset[2] * _strides[2];
+    }
+
+    [[nodiscard]]
+    bool GetDirect(const int index) const {
+        return (_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+    }
+
+    void SetDirect(const int index, const bool value) {
+        const auto bit = std::uint64_t{1} << (index % WORD_BITS);
+        auto& word = _words[index / WORD_BITS];
+        word = value ? word | bit : word & ~bit;
+    }
+
+    [[nodiscard]]
+    bool operator[](const LatticeCoord& coords) const {
+        return GetDirect(IndexFromCoords(coords));
+    }
+
+    void Set(const LatticeCoord& coords, const bool value) {
+        SetDirect(IndexFromCoords(coords), value);
+    }
+
+    // Set the bit at coords, returning whether it was already set
+    bool TestAndSet(const LatticeCoord& coords) {
+        const int index = IndexFromCoords(coords);
+        const auto bit = std::uint64_t{1} << (index % WORD_BITS);
+        auto& word = _words[index / WORD_BITS];
+        const bool wasSet = word & bit;
+        word |= bit;
+        return wasSet;
+    }
+
+    // Set every cell to value
+    void Fill(const bool value) {
+        std::fill(_words.begin(), _words.end(), value ? ~std::uint64_t{0} : 0);
+        if (value && !_words.empty()) {
+            _words.back() &= TailMask();
+        }
+    }
+
+    bool operator==(const BitTensor& right) const = default;
+};
+
+#endif //MODULAR_ROBOTICS_BITTENSOR_H
@@ -0,0 +1,114 @@
+#ifndef MODULAR_ROBOTICS_COORD_H
+#define MODULAR_ROBOTICS_COORD_H
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <valarray>
+#include <vector>
+
+// Highest lattice order that module and move coordinates can represent, lower order lattices leave the remaining
+// coordinates at 0
+#define COORD_MAX_ORDER 3
+
+// Fixed size coordinate vector. Unlike std::valarray<int> it never allocates, so coordinates can be added, compared and
+// copied freely in hot paths.
+template<std::size_t N>
+class Coord {
+private:
+    std::array<std::int16_t, N> _coords{};
+public:
+    constexpr Coord() = default;
+
+    // Missing coordinates are set to 0
+    constexpr Coord(const std::initializer_list<int> coords) {
+        std::size_t i = 0;
+        for (auto it = coords.begin(); it != coords.end() && i < N; ++it, ++i) {
+            _coords[i] = static_cast<std::int16_t>(*it);
+        }
+    }
+
+    // Implicit conversions from the dynamically sized types used when reading JSON
+    Coord(const std::valarray<int>& coords) { // NOLINT(*-explicit-constructor)
+        for (std::size_t i = 0; i < N && i < coords.size(); i++) {
+            _coords[i] = static_cast<std::int16_t>(coords[i]);
+        }
+    }
+
+    Coord(const std::vector<int>& coords) { // NOLINT(*-explicit-constructor)
+        for (std::size_t i = 0; i < N && i < coords.size(); i++) {
+            _coords[i] = static_cast<std::int16_t>(coords[i]);
+        }
+    }
+
+    [[nodiscard]]
+    static constexpr std::size_t size() {
+        return N;
+    }
+
+    constexpr std::int16_t& operator[](const std::size_t index) {
+        return _coords[index];
+    }
+
+    constexpr int operator[](const std::size_t index) const {
+        return _coords[index];
+    }
+
+    constexpr auto begin() const {
+        return _coords.begin();
+    }
+
+    constexpr auto end() const {
+        return _coords.end();
+    }
+
+    constexpr Coord& operator+=(const Coord& right) {
+        for (std::size_t i = 0; i < N; i++) {
+            _coords[i] += right._coords[i];
+        }
+        return *this;
+    }
+
+    constexpr Coord& operator-=(const Coord& right) {
+        for (std::size_t i = 0; i < N; i++) {
+            _coords[i] -= right._coords[i];
+        }
+        return *this;
+    }
+
+    constexpr Coord operator+(const Coord& right) const {
+        Coord result = *this;
+        return result += right;
+    }
+
+    constexpr Coord operator-(const Coord& right) const {
+        Coord result = *this;
+        return result -= right;
+    }
+
+    constexpr Coord operator-() const {
+        return Coord() - *this;
+    }
+
+    constexpr bool operator==(const Coord& right) const = default;
+
+    constexpr auto operator<=>(const Coord& right) const = default;
+
+    // Convert to a valarray holding the first order coordinates
+    [[nodiscard]]
+    std::valarray<int> ToValarray(const int order = N) const {
+        std::valarray<int> result(order);
+        for (int i = 0; i < order; i++) {
+            result[i] = _coords[i];
+        }
+        return result;
+    }
+};
+
+// Coordinate type used for modules and moves
+using LatticeCoord = Coord<COORD_MAX_ORDER>;
+
+static_assert(std::is_trivially_copyable_v<LatticeCoord>);
+
+#endif //MODULAR_ROBOTICS_COORD_H
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <array>
+#include <unordered_map>
 #include <valarray>
 #include <vector>
 #include <cstring>
@@ -5,10 +8,33 @@
 #include <iostream>
 #include <cmath>
 #include "../utility/debug_util.h"
+#include "Coord.h"
+#include "Morton.h"
 
 #ifndef TENSORFINAL_COORDTENSOR_H
 #define TENSORFINAL_COORDTENSOR_H
 
+/* Sparse Chunk Size Configuration
+ * Sparse tensors allocate cells in chunks of 2^COORDTENSOR_CHUNK_BITS cells that are consecutive in memory order
+ */
+#define COORDTENSOR_CHUNK_BITS 6
+
+enum TensorStorage {
+    // Every cell is held in a single contiguous array
+    TENSOR_DENSE,
+    // Cells are held in chunks that are allocated the first time they are accessed through a non-const reference,
+    // memory use scales with the area that is actually touched instead of the volume of the tensor
+    TENSOR_SPARSE
+};
+
+enum TensorLayout {
+    // Cells are ordered with the x-axis varying fastest
+    TENSOR_LINEAR,
+    // Cells are ordered along a Morton (Z-order) curve, only used for 3rd order tensors with an axis size of at most
+    // MORTON_MAX_AXIS, other tensors fall back to linear layout. The tensor is padded up to a power of 2 on every axis.
+    TENSOR_MORTON
+};
+
 template <typename T>
 class CoordTensor {
 public:
@@ -17,10 +43,15 @@ public:
     // represent a point in space.
     // Axis size determines the length of each axis, an axis size of 10
     // would mean that only the integers 0-9 would be valid coordinates.
-    CoordTensor(int order, int axisSize, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset = {});
+    // Storage determines whether cells are held densely or in sparsely allocated chunks.
+    // Layout determines the order of cells in memory.
+    CoordTensor(int order, int axisSize, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset = {}, TensorStorage storage = TENSOR_DENSE, TensorLayout layout = TENSOR_LINEAR);
+
+    // Constructor for tensors whose axes may differ in length, the order is the number of axis sizes given.
+    CoordTensor(const std::vector<int>& axisSizes, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset = {}, TensorStorage storage = TENSOR_DENSE, TensorLayout layout = TENSOR_LINEAR);
 
     // Gets a reference to an ID directly from the internal array, this
-    // is always faster than calling IdAtInternal but requires a pre-calculated
+    // is always faster than calling ElementAt but requires a pre-calculated
     // index in order to work.
     typename std::vector<T>::reference GetElementDirect(int index);
 
@@ -41,21 +72,82 @@ public:
     [[nodiscard]]
     typename std::vector<T>::const_reference operator[](const std::valarray<int>& coords) const;
 
-    // Get a const reference to the internal array
+    // Coord overloads of ElementAt and operator[], these avoid the valarray temporaries of the valarray versions.
+    // Coordinates beyond the order of the tensor must be 0.
+    template<std::size_t N>
+    typename std::vector<T>::reference ElementAt(const Coord<N>& coords);
+
+    template<std::size_t N>
+    [[nodiscard]]
+    typename std::vector<T>::const_reference ElementAt(const Coord<N>& coords) const;
+
+    template<std::size_t N>
+    typename std::vector<T>::reference operator[](const Coord<N>& coords);
+
+    template<std::size_t N>
+    [[nodiscard]]
+    typename std::vector<T>::const_reference operator[](const Coord<N>& coords) const;
+
+    // Get the internal array index of a coordinate
+    template<std::size_t N>
+    [[nodiscard]]
+    int IndexFromCoords(const Coord<N>& coords) const;
+
+    // Get the change in internal array index caused by moving by offset, so that
+    // IndexFromCoords(coords + offset) == IndexFromCoords(coords) + IndexOffset(offset), linear layout only
+    template<std::size_t N>
+    [[nodiscard]]
+    int IndexOffset(const Coord<N>& offset) const;
+
+    // Get the change in internal array index caused by moving 1 along an axis, linear layout only
+    [[nodiscard]]
+    int Stride(int axis) const;
+
+    // Get a const reference to the internal array, only valid for dense tensors
     [[nodiscard]]
     const std::vector<T>& GetArrayInternal() const;
 
+    // Get the number of cells in the tensor
+    [[nodiscard]]
+    int Size() const;
+
+    // Get the storage backend of the tensor
+    [[nodiscard]]
+    TensorStorage Storage() const;
+
+    // Get the memory layout of the tensor
+    [[nodiscard]]
+    TensorLayout Layout() const;
+
+    // Check whether an index belongs to the padding added by the memory layout rather than to a valid coordinate
+    [[nodiscard]]
+    bool IsPadding(int index) const;
+
+    // Assign a value to every cell within width of the edge of the tensor, for sparse tensors this also becomes the
+    // value of border cells in chunks that have not been allocated yet
+    void SetBorder(int width, const typename std::vector<T>::value_type& value);
+
     // Get a copy of order
     [[nodiscard]]
     int Order() const;
 
-    // Get a copy of axisSize
+    // Get the length of the longest axis
     [[nodiscard]]
     int AxisSize() const;
 
-    // Get a coordinate vector from an index
+    // Get the length of an axis
+    [[nodiscard]]
+    int AxisSize(int axis) const;
+
+    // Get the length of every axis
     [[nodiscard]]
-    const std::valarray<int>& CoordsFromIndex(int index) const;
+    const std::vector<int>& AxisSizes() const;
+
+    // Get a coordinate vector from an index, coordinates are decoded on the fly. Only the first N axes are decoded, any
+    // remaining coordinates are left at 0.
+    template<std::size_t N = COORD_MAX_ORDER>
+    [[nodiscard]]
+    Coord<N> CoordsFromIndex(int index) const;
 
     // Assign a value to every position in the tensor
     void Fill(const typename std::vector<T>::value_type& value);
@@ -63,265 +155,307 @@ public:
     void FillFromVector(const std::vector<T>& vec);
 
     // Comparison Operators
-    bool operator==(const CoordTensor<T>& right) const;
-    bool operator!=(const CoordTensor<T>& right) const;
+    bool operator==(const CoordTensor& right) const;
+    bool operator!=(const CoordTensor& right) const;
 private:
+    // Enough strides are kept for any Coord type, unused strides stay at 0
+    static constexpr std::size_t STRIDE_COUNT = COORD_MAX_ORDER + 1;
+
     int _order;
-    // Axis size, useful for bounds checking
+    // Length of the longest axis
     int _axisSize;
-    // Origin offset
-    std::valarray<int> _offset;
-    // Coordinate multiplier cache for tensors of order > 3
+    // Length of each axis
+    std::vector<int> _axisSizes;
+    // Number of cells
+    int _size;
+    // Internal array index of the origin, only non-zero if the tensor has an origin offset
+    int _originIndex = 0;
+    // Coordinate multiplier cache used by Coord lookups
+    std::array<int, STRIDE_COUNT> _strides{};
+    // Coordinate multiplier cache used by valarray lookups, covers every axis
     std::valarray<int> _axisMultipliers;
-    // Internal array for rapid conversion from index to coordinate
-    std::vector<std::valarray<int>> _coordsInternal;
     // Internal array responsible for holding module IDs
     std::vector<T> _arrayInternal;
-    // Internal array responsible for holding slices of _arrayInternal
-    std::vector<T*> _arrayInternal2D;
-    // Internal array responsible for holding slices of _arrayInternal2D
-    std::vector<T**> _arrayInternal3D;
-    // Did you know that calling member function pointers looks really weird?
-    typename std::vector<T>::reference (CoordTensor::*IdAtInternal)(const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference (CoordTensor::*IdAtInternalConst)(const std::valarray<int>& coords) const;
-    typename std::vector<T>::reference (CoordTensor::*IdAtInternalOffset)(const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference (CoordTensor::*IdAtInternalOffsetConst)(const std::valarray<int>& coords) const;
-    // 2nd and 3rd order tensors benefit from specialized IdAt functions
-    typename std::vector<T>::reference ElemAt2ndOrder (const std::valarray<int>& coords);
+    // Storage backend
+    TensorStorage _storage;
+    // Memory layout
+    TensorLayout _layout = TENSOR_LINEAR;
+    // Origin offset, used by layouts that cannot fold the offset into _originIndex
+    std::array<int, STRIDE_COUNT> _originCoords{};
+    // Chunks of a sparse tensor, indexed by internal array index >> COORDTENSOR_CHUNK_BITS
+    std::unordered_map<int, std::vector<T>> _chunks;
+    // Value of cells in unallocated chunks
+    T _defaultValue;
+    // Width and value of the border set by SetBorder
+    int _borderWidth = 0;
+    T _borderValue;
+
+    // Get the internal array index of a valarray coordinate
     [[nodiscard]]
-    typename std::vector<T>::const_reference ElemAt2ndOrderConst (const std::valarray<int>& coords) const;
-    typename std::vector<T>::reference ElemAt3rdOrder (const std::valarray<int>& coords);
+    int IndexFromValarray(const std::valarray<int>& coords) const;
+
+    // Get a cell by internal array index, regardless of storage backend
+    typename std::vector<T>::reference Cell(int index);
+
+    [[nodiscard]]
+    typename std::vector<T>::const_reference Cell(int index) const;
+
+    // Check whether an internal array index lies within the border
     [[nodiscard]]
-    typename std::vector<T>::const_reference ElemAt3rdOrderConst (const std::valarray<int>& coords) const;
-    // Generalized IdAtInternal function
-    typename std::vector<T>::reference ElemAtNthOrder (const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference ElemAtNthOrderConst (const std::valarray<int>& coords) const;
-    // Offset IdAt
-    typename std::vector<T>::reference ElemAtNthOrderOffset (const std::valarray<int>& coords);
-    typename std::vector<T>::const_reference ElemAtNthOrderOffsetConst (const std::valarray<int>& coords) const;
+    bool InBorder(int index) const;
+
+    // Get the value of a cell in a sparse tensor that has not been allocated
+    [[nodiscard]]
+    const T& UnallocatedValue(int index) const;
 };
 
-template<typename T>
-bool CoordTensor<T>::operator==(const CoordTensor<T>& right) const {
-    return _arrayInternal == right._arrayInternal;
+template <typename T>
+bool CoordTensor<T>::operator==(const CoordTensor& right) const {
+    if (_storage == TENSOR_DENSE && right._storage == TENSOR_DENSE) {
+        return _arrayInternal == right._arrayInternal;
+    }
+    if (_size != right._size) {
+        return false;
+    }
+    for (int i = 0; i < _size; i++) {
+        if (Cell(i) != right.Cell(i)) {
+            return false;
+        }
+    }
+    return true;
 }
 
-template<typename T>
-bool CoordTensor<T>::operator!=(const CoordTensor<T>& right) const {
-    return _arrayInternal != right._arrayInternal;
+template <typename T>
+bool CoordTensor<T>::operator!=(const CoordTensor& right) const {
+    return !(*this == right);
 }
 
-template<typename T>
+template <typename T>
 int CoordTensor<T>::Order() const {
     return _order;
 }
 
-template<typename T>
+template <typename T>
 int CoordTensor<T>::AxisSize() const {
     return _axisSize;
 }
 
-template<typename T>
-const std::valarray<int>& CoordTensor<T>::CoordsFromIndex(int index) const {
-    return _coordsInternal[index];
+template <typename T>
+int CoordTensor<T>::AxisSize(const int axis) const {
+    return _axisSizes[axis];
+}
+
+template <typename T>
+const std::vector<int>& CoordTensor<T>::AxisSizes() const {
+    return _axisSizes;
 }
 
 template <typename T>
-CoordTensor<T>::CoordTensor(int order, int axisSize, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset) {
-    _order = order;
-    _axisSize = axisSize;
-    // Calculate number of elements in tensor
-    int internalSize = (int) std::pow(_axisSize, order);
-    // Resize internal array to accommodate all elements
-    _arrayInternal.resize(internalSize, value);
-    // Setup Index -> Coordinate array
-    _coordsInternal.resize(internalSize);
-    std::valarray<int> coords;
-    coords.resize(order, 0);
-    for (int i = 0; i < internalSize; i++) {
-        _coordsInternal[i] = coords;
-        for (int j = 0; j < order; j++) {
-            if (++coords[j] == axisSize) {
-                coords[j] = 0;
-            } else break;
+template<std::size_t N>
+Coord<N> CoordTensor<T>::CoordsFromIndex(int index) const {
+    Coord<N> coords;
+    const int count = std::min(static_cast<int>(N), Order());
+    if (_layout == TENSOR_MORTON) {
+        for (int i = 0; i < count; i++) {
+            coords[i] = Morton::Coord(index, i); // NOLINT(*-narrowing-conversions)
         }
+        return coords;
     }
-    // Set size of 2nd order array
-    internalSize = _axisSize;
-    switch (order) {
-        case 3:
-            // 2nd order array will need to be larger if tensor is 3rd order
-            internalSize *= _axisSize;
-        case 2:
-            // Initialize 2nd order array
-            _arrayInternal2D.resize(internalSize);
-            for (int i = 0; i < internalSize; i++) {
-                _arrayInternal2D[i] = &(_arrayInternal[i * _axisSize]);
-            }
-            if (internalSize == _axisSize) {
-                // If internalSize wasn't modified by case 3, then tensor is 2nd order
-                IdAtInternal = &CoordTensor::ElemAt2ndOrder;
-                IdAtInternalConst = &CoordTensor::ElemAt2ndOrderConst;
-                DEBUG("2nd order tensor created\n");
-                break;
-            }
-            // Otherwise tensor is 3rd order
-            // Initialize 3rd order array
-            _arrayInternal3D.resize(_axisSize);
-            for (int i = 0; i < _axisSize; i++) {
-                _arrayInternal3D[i] = &(_arrayInternal2D[i * _axisSize]);
-            }
-            IdAtInternal = &CoordTensor::ElemAt3rdOrder;
-            IdAtInternalConst = &CoordTensor::ElemAt3rdOrderConst;
-            DEBUG("3rd order tensor created\n");
-            break;
-        default:
-            // If the tensor is not 2nd or 3rd order then the
-            // coordinate multiplier cache needs to be set up
-            _axisMultipliers.resize(order);
-            int multiplier = 1;
-            for (int i = 0; i < order; i++) {
-                _axisMultipliers[i] = multiplier;
-                multiplier *= _axisSize;
-            }
-            IdAtInternal = &CoordTensor::ElemAtNthOrder;
-            IdAtInternalConst = &CoordTensor::ElemAtNthOrderConst;
-            DEBUG("Tensor of order " << order << " created\n");
-    }
-    // Offset setup
-    if (originOffset.size() != 0) {
-        _offset = originOffset;
-        IdAtInternalOffset = IdAtInternal;
-        IdAtInternalOffsetConst = IdAtInternalConst;
-        IdAtInternal = &CoordTensor::ElemAtNthOrderOffset;
-        IdAtInternalConst = &CoordTensor::ElemAtNthOrderOffsetConst;
+    for (int i = 0; i < count; i++) {
+        coords[i] = index % _axisSizes[i]; // NOLINT(*-narrowing-conversions)
+        index /= _axisSizes[i];
     }
-#ifndef NDEBUG
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "ConstantConditionsOC"
-#pragma ide diagnostic ignored "UnreachableCode"
-    std::cout << "IdAtInternal Function: " << (
-            IdAtInternal == &CoordTensor::ElemAt3rdOrder ? "ElemAt3rdOrder" :
-            IdAtInternal == &CoordTensor::ElemAt2ndOrder ? "ElemAt2ndOrder" :
-            IdAtInternal == &CoordTensor::ElemAtNthOrder ? "ElemAtNthOrder" :
-            IdAtInternal == &CoordTensor::ElemAtNthOrderOffset ? "ElemAtNthOrderOffset" :
-            "Invalid Function!") << std::endl;
-#pragma clang diagnostic pop
-#endif
-}
-
-template<>
-inline CoordTensor<bool>::CoordTensor(int order, int axisSize, const typename std::vector<bool>::value_type& value, const std::valarray<int>& originOffset) {
+    return coords;
+}
+
+template <typename T>
+CoordTensor<T>::CoordTensor(const int order, const int axisSize, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset, const TensorStorage storage, const TensorLayout layout)
+        : CoordTensor(std::vector<int>(order, axisSize), value, originOffset, storage, layout) {}
+
+template <typename T>
+CoordTensor<T>::CoordTensor(const std::vector<int>& axisSizes, const typename std::vector<T>::value_type& value, const std::valarray<int>& originOffset, const TensorStorage storage, const TensorLayout layout)
+        : _axisSizes(axisSizes), _storage(storage), _defaultValue(value), _borderValue(value) {
+    const int order = static_cast<int>(axisSizes.size());
     _order = order;
-    _axisSize = axisSize;
+    _axisSize = *std::max_element(_axisSizes.begin(), _axisSizes.end());
     // Calculate number of elements in tensor
-    int internalSize = (int) std::pow(_axisSize, order);
-    // Resize internal array to accommodate all elements
-    _arrayInternal.resize(internalSize, value);
-    // Setup Index -> Coordinate array
-    _coordsInternal.resize(internalSize);
-    std::valarray<int> coords;
-    coords.resize(order, 0);
-    for (int i = 0; i < internalSize; i++) {
-        _coordsInternal[i] = coords;
-        for (int j = 0; j < order; j++) {
-            if (++coords[j] == axisSize) {
-                coords[j] = 0;
-            } else break;
+    if (layout == TENSOR_MORTON && order == 3 && _axisSize <= MORTON_MAX_AXIS) {
+        _layout = TENSOR_MORTON;
+        _size = (int) std::pow(Morton::PaddedAxisSize(_axisSize), order);
+    } else {
+        _size = 1;
+        for (const int size : _axisSizes) {
+            _size *= size;
         }
     }
-    // If the tensor is not 2nd or 3rd order then the
-    // coordinate multiplier cache needs to be set up
+    // Resize internal array to accommodate all elements, sparse tensors allocate chunks as needed instead
+    if (_storage == TENSOR_DENSE) {
+        _arrayInternal.resize(_size, value);
+    }
+    // Set up coordinate multiplier caches
     _axisMultipliers.resize(order);
     int multiplier = 1;
     for (int i = 0; i < order; i++) {
         _axisMultipliers[i] = multiplier;
-        multiplier *= _axisSize;
+        if (i < STRIDE_COUNT) {
+            _strides[i] = multiplier;
+        }
+        multiplier *= _axisSizes[i];
     }
-    IdAtInternal = &CoordTensor::ElemAtNthOrder;
-    IdAtInternalConst = &CoordTensor::ElemAtNthOrderConst;
-    DEBUG("Tensor of order " << order << " created\n");
-    // Offset setup
-    if (originOffset.size() != 0) {
-        _offset = originOffset;
-        IdAtInternalOffset = IdAtInternal;
-        IdAtInternalOffsetConst = IdAtInternalConst;
-        IdAtInternal = &CoordTensor::ElemAtNthOrderOffset;
-        IdAtInternalConst = &CoordTensor::ElemAtNthOrderOffsetConst;
+    // Offset setup, the offset is folded into the index of the origin
+    for (int i = 0; i < originOffset.size(); i++) {
+        _originIndex += originOffset[i] * _axisMultipliers[i];
+        if (i < STRIDE_COUNT) {
+            _originCoords[i] = originOffset[i];
+        }
     }
-#ifndef NDEBUG
-#pragma clang diagnostic push
-#pragma ide diagnostic ignored "ConstantConditionsOC"
-#pragma ide diagnostic ignored "UnreachableCode"
-    std::cout << "IdAtInternal Function: " << (
-            IdAtInternal == &CoordTensor::ElemAtNthOrder ? "ElemAtNthOrder" :
-            IdAtInternal == &CoordTensor::ElemAtNthOrderOffset ? "ElemAtNthOrderOffset" :
-            "Invalid Function!") << std::endl;
-#pragma clang diagnostic pop
-#endif
+    DEBUG("Tensor of order " << order << " created\n");
 }
 
 template <typename T>
 typename std::vector<T>::reference CoordTensor<T>::GetElementDirect(int index) {
-    return _arrayInternal[index];
+    return Cell(index);
 }
 
 template <typename T>
 typename std::vector<T>::const_reference CoordTensor<T>::GetElementDirect(int index) const {
-    return _arrayInternal[index];
+    return Cell(index);
+}
+
+template <typename T>
+inline typename std::vector<T>::reference CoordTensor<T>::Cell(const int index) {
+    if (_storage == TENSOR_DENSE) [[likely]] {
+        return _arrayInternal[index];
+    }
+    auto& chunk = _chunks[index >> COORDTENSOR_CHUNK_BITS];
+    if (chunk.empty()) {
+        // First access, initialize chunk to the values it held implicitly
+        const int chunkStart = index & ~((1 << COORDTENSOR_CHUNK_BITS) - 1);
+        chunk.reserve(1 << COORDTENSOR_CHUNK_BITS);
+        for (int i = 0; i < 1 << COORDTENSOR_CHUNK_BITS; i++) {
+            chunk.push_back(UnallocatedValue(chunkStart + i));
+        }
+    }
+    return chunk[index & ((1 << COORDTENSOR_CHUNK_BITS) - 1)];
+}
+
+template <typename T>
+inline typename std::vector<T>::const_reference CoordTensor<T>::Cell(const int index) const {
+    if (_storage == TENSOR_DENSE) [[likely]] {
+        return _arrayInternal[index];
+    }
+    if (const auto chunk = _chunks.find(index >> COORDTENSOR_CHUNK_BITS); chunk != _chunks.end()) {
+        return chunk->second[index & ((1 << COORDTENSOR_CHUNK_BITS) - 1)];
+    }
+    return UnallocatedValue(index);
+}
+
+template <typename T>
+bool CoordTensor<T>::InBorder(int index) const {
+    if (_layout == TENSOR_MORTON) {
+        for (int i = 0; i < _order; i++) {
+            if (const int coord = Morton::Coord(index, i); coord < _borderWidth || coord >= _axisSizes[i] - _borderWidth) {
+                return true;
+            }
+        }
+        return false;
+    }
+    if (_borderWidth == 0) return false;
+    for (int i = 0; i < _order; i++) {
+        if (const int coord = index % _axisSizes[i]; coord < _borderWidth || coord >= _axisSizes[i] - _borderWidth) {
+            return true;
+        }
+        index /= _axisSizes[i];
+    }
+    return false;
+}
+
+template <typename T>
+const T& CoordTensor<T>::UnallocatedValue(const int index) const {
+    return InBorder(index) ? _borderValue : _defaultValue;
+}
+
+template <typename T>
+inline int CoordTensor<T>::IndexFromValarray(const std::valarray<int>& coords) const {
+    if (_layout == TENSOR_MORTON) {
+        return Morton::Index(coords[0] + _originCoords[0], coords[1] + _originCoords[1], coords[2] + _originCoords[2]);
+    }
+    int index = _originIndex;
+    for (int i = 0; i < _order; i++) {
+        index += coords[i] * _axisMultipliers[i];
+    }
+    return index;
 }
 
 template <typename T>
 inline typename std::vector<T>::reference CoordTensor<T>::ElementAt(const std::valarray<int>& coords) {
-    // Told you calling member function pointers looks weird
-    return (this->*IdAtInternal)(coords);
-    // This would look even worse if IdAtInternal were called from outside,
-    // it'd look like this: (tensor3D.*(tensor3D.IdAtInternal))({8, 4, 6}) <-- Not Good
+    return Cell(IndexFromValarray(coords));
 }
 
 template <typename T>
 inline typename std::vector<T>::const_reference CoordTensor<T>::ElementAt(const std::valarray<int>& coords) const {
-    return (this->*IdAtInternalConst)(coords);
+    return Cell(IndexFromValarray(coords));
 }
 
 template <typename T>
-typename std::vector<T>::reference CoordTensor<T>::ElemAt2ndOrder (const std::valarray<int>& coords) {
-    return _arrayInternal2D[coords[1]][coords[0]];
+typename std::vector<T>::reference CoordTensor<T>::operator[](const std::valarray<int> &coords) {
+    return Cell(IndexFromValarray(coords));
 }
 
 template <typename T>
-typename std::vector<T>::const_reference CoordTensor<T>::ElemAt2ndOrderConst (const std::valarray<int>& coords) const {
-    return _arrayInternal2D[coords[1]][coords[0]];
+typename std::vector<T>::const_reference CoordTensor<T>::operator[](const std::valarray<int>& coords) const {
+    return Cell(IndexFromValarray(coords));
 }
 
 template <typename T>
-typename std::vector<T>::reference CoordTensor<T>::ElemAt3rdOrder (const std::valarray<int>& coords) {
-    return _arrayInternal3D[coords[2]][coords[1]][coords[0]];
+template <std::size_t N>
+inline int CoordTensor<T>::IndexOffset(const Coord<N>& offset) const {
+    static_assert(N <= STRIDE_COUNT, "Tensors cannot be indexed with more than COORD_MAX_ORDER + 1 coordinates");
+    int index = 0;
+    for (std::size_t i = 0; i < N; i++) {
+        index += offset[i] * _strides[i];
+    }
+    return index;
 }
 
 template <typename T>
-typename std::vector<T>::const_reference CoordTensor<T>::ElemAt3rdOrderConst (const std::valarray<int>& coords) const {
-    return _arrayInternal3D[coords[2]][coords[1]][coords[0]];
+template <std::size_t N>
+inline int CoordTensor<T>::IndexFromCoords(const Coord<N>& coords) const {
+    if constexpr (N >= 3) {
+        if (_layout == TENSOR_MORTON) {
+            return Morton::Index(coords[0] + _originCoords[0], coords[1] + _originCoords[1], coords[2] + _originCoords[2]);
+        }
+    }
+    return _originIndex + IndexOffset(coords);
 }
 
 template <typename T>
-typename std::vector<T>::reference CoordTensor<T>::ElemAtNthOrder (const std::valarray<int>& coords) {
-    return _arrayInternal[(coords * _axisMultipliers).sum()];
+int CoordTensor<T>::Stride(const int axis) const {
+    return _axisMultipliers[axis];
 }
 
 template <typename T>
-typename std::vector<T>::const_reference CoordTensor<T>::ElemAtNthOrderConst (const std::valarray<int>& coords) const {
-    return _arrayInternal[(coords * _axisMultipliers).sum()];
+template <std::size_t N>
+inline typename std::vector<T>::reference CoordTensor<T>::ElementAt(const Coord<N>& coords) {
+    return Cell(IndexFromCoords(coords));
 }
 
 template <typename T>
-typename std::vector<T>::reference CoordTensor<T>::operator[](const std::valarray<int> &coords) {
-    return (this->*IdAtInternal)(coords);
+template <std::size_t N>
+inline typename std::vector<T>::const_reference CoordTensor<T>::ElementAt(const Coord<N>& coords) const {
+    return Cell(IndexFromCoords(coords));
 }
 
 template <typename T>
-typename std::vector<T>::const_reference CoordTensor<T>::operator[](const std::valarray<int>& coords) const {
-    return (this->*IdAtInternalConst)(coords);
+template <std::size_t N>
+inline typename std::vector<T>::reference CoordTensor<T>::operator[](const Coord<N>& coords) {
+    return Cell(IndexFromCoords(coords));
+}
+
+template <typename T>
+template <std::size_t N>
+inline typename std::vector<T>::const_reference CoordTensor<T>::operator[](const Coord<N>& coords) const {
+    return Cell(IndexFromCoords(coords));
 }
 
 template <typename T>
@@ -330,21 +464,58 @@ const std::vector<T>& CoordTensor<T>::GetArrayInternal() const {
 }
 
 template <typename T>
-inline typename std::vector<T>::reference CoordTensor<T>::ElemAtNthOrderOffset (const std::valarray<int>& coords) {
-    return (this->*IdAtInternalOffset)(coords + _offset);
+int CoordTensor<T>::Size() const {
+    return _size;
+}
+
+template <typename T>
+TensorStorage CoordTensor<T>::Storage() const {
+    return _storage;
 }
 
 template <typename T>
-inline typename std::vector<T>::const_reference CoordTensor<T>::ElemAtNthOrderOffsetConst (const std::valarray<int>& coords) const {
-    return (this->*IdAtInternalOffsetConst)(coords + _offset);
+TensorLayout CoordTensor<T>::Layout() const {
+    return _layout;
 }
 
-template<typename T>
+template <typename T>
+bool CoordTensor<T>::IsPadding(const int index) const {
+    if (_layout != TENSOR_MORTON) return false;
+    for (int i = 0; i < _order; i++) {
+        if (Morton::Coord(index, i) >= _axisSizes[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void CoordTensor<T>::SetBorder(const int width, const typename std::vector<T>::value_type& value) {
+    _borderWidth = width;
+    _borderValue = value;
+    if (_storage == TENSOR_DENSE) {
+        for (int i = 0; i < _size; i++) {
+            if (InBorder(i)) {
+                _arrayInternal[i] = value;
+            }
+        }
+    } else {
+        for (auto& [chunkIndex, chunk] : _chunks) {
+            for (int i = 0; i < chunk.size(); i++) {
+                if (InBorder((chunkIndex << COORDTENSOR_CHUNK_BITS) + i)) {
+                    chunk[i] = value;
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
 void CoordTensor<T>::Fill(const typename std::vector<T>::value_type &value) {
     std::memset(_arrayInternal.data(), value, sizeof(_arrayInternal));
 }
 
-template<typename T>
+template <typename T>
 void CoordTensor<T>::FillFromVector(const std::vector<T> &vec) {
     _arrayInternal = vec;
 }
@@ -0,0 +1,54 @@
+#ifndef MODULAR_ROBOTICS_MORTON_H
+#define MODULAR_ROBOTICS_MORTON_H
+
+#include <cstdint>
+
+// Largest axis size that a 3rd order Morton index can represent, 10 bits per axis
+#define MORTON_MAX_AXIS 1024
+
+// Morton (Z-order) index helpers for 3rd order coordinates. Bits of the x, y and z coordinates are interleaved so that
+// cells that are close to each other on any axis are usually close to each other in memory.
+namespace Morton {
+    // Spread the lower 10 bits of value out so that there are 2 zero bits between each of them
+    constexpr std::uint32_t Dilate(std::uint32_t value) {
+        value &= 0x000003FF;
+        value = (value | (value << 16)) & 0xFF0000FF;
+        value = (value | (value << 8)) & 0x0300F00F;
+        value = (value | (value << 4)) & 0x030C30C3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    }
+
+    // Inverse of Dilate
+    constexpr std::uint32_t Compact(std::uint32_t value) {
+        value &= 0x09249249;
+        value = (value | (value >> 2)) & 0x030C30C3;
+        value = (value | (value >> 4)) & 0x0300F00F;
+        value = (value | (value >> 8)) & 0xFF0000FF;
+        value = (value | (value >> 16)) & 0x000003FF;
+        return value;
+    }
+
+    constexpr int Index(const int x, const int y, const int z) {
+        return static_cast<int>(Dilate(x) | (Dilate(y) << 1) | (Dilate(z) << 2));
+    }
+
+    // Get the coordinate on axis (0 to 2) from a Morton index
+    constexpr int Coord(const int index, const int axis) {
+        return static_cast<int>(Compact(static_cast<std::uint32_t>(index) >> axis));
+    }
+
+    // Smallest power of 2 that is at least axisSize, a Morton ordered tensor is padded to this size on every axis
+    constexpr int PaddedAxisSize(const int axisSize) {
+        int padded = 1;
+        while (padded < axisSize) {
+            padded <<= 1;
+        }
+        return padded;
+    }
+}
+
+static_assert(Morton::Index(1, 2, 3) == 0b110101);
+static_assert(Morton::Coord(Morton::Index(5, 1000, 77), 1) == 1000);
+
+#endif //MODULAR_ROBOTICS_MORTON_H
@@ -3,99 +3,152 @@
 #include <sstream>
 #include <string>
 #include <map>
+#include <bit>
+#include <bitset>
+#include <utility>
 #include "../utility/debug_util.h"
 #include "../utility/color_util.h"
 #include "Lattice.h"
 
-std::vector<std::vector<int>> Lattice::adjList;
+std::vector<std::uint32_t> Lattice::adjMasks;
+std::vector<LatticeCoord> Lattice::adjOffsets;
 int Lattice::order;
 int Lattice::axisSize;
+std::vector<int> Lattice::axisSizes;
 int Lattice::boundarySize;
 int Lattice::time = 0;
 int Lattice::moduleCount = 0;
 bool Lattice::ignoreProperties = false;
+LatticeGeometry Lattice::geometry = GEOMETRY_CUBE;
 std::valarray<int> Lattice::boundaryOffset;
+LatticeCoord Lattice::cropOrigin;
 std::vector<Module*> Lattice::movableModules;
-CoordTensor<bool> Lattice::stateTensor(1, 1, false);
 CoordTensor<int> Lattice::coordTensor(1, 1, -1);
 
 void Lattice::ClearAdjacencies(const int moduleId) {
-    for (const int id : adjList[moduleId]) {
-        for (int i = 0; i < adjList[id].size(); i++) {
-            if (adjList[id][i] == moduleId) {
-                adjList[id].erase(adjList[id].begin() + i);
-                break;
-            }
-        }
+    VisitGeometry(geometry, order, [moduleId]<typename Geometry>(Geometry) {
+        ClearAdjacenciesFor<Geometry>(moduleId);
+    });
+}
+
+template<typename Geometry>
+void Lattice::ClearAdjacenciesFor(const int moduleId) {
+    const auto& mod = ModuleIdManager::GetModule(moduleId);
+    for (auto mask = adjMasks[moduleId]; mask != 0; mask &= mask - 1) {
+        const int direction = std::countr_zero(mask);
+        // Opposite directions only differ in the lowest bit
+        adjMasks[coordTensor[mod.coords + Geometry::offsets[direction]]] &= ~(1u << (direction ^ 1));
     }
-    adjList[moduleId].clear();
+    adjMasks[moduleId] = 0;
+}
+
+int Lattice::NeighborId(const Module& mod, const int direction) {
+    return coordTensor[mod.coords + adjOffsets[direction]];
 }
 
-void Lattice::InitLattice(const int _order, const int _axisSize, const int _boundarySize) {
+void Lattice::AllocateTensors() {
+    double cellCount = 1;
+    for (const int size : axisSizes) {
+        cellCount *= size;
+    }
+    const auto storage = cellCount >= LATTICE_SPARSE_THRESHOLD ? TENSOR_SPARSE : TENSOR_DENSE;
+    constexpr auto layout = LATTICE_MORTON_LAYOUT ? TENSOR_MORTON : TENSOR_LINEAR;
+    coordTensor = CoordTensor<int>(axisSizes, FREE_SPACE, {}, storage, layout);
+    coordTensor.SetBorder(boundarySize, OUT_OF_BOUNDS);
+}
+
+void Lattice::InitLattice(const int _order, const int _axisSize, const int _boundarySize, const LatticeGeometry _geometry) {
     order = _order;
     axisSize = _axisSize + 2 * _boundarySize;
+    axisSizes = std::vector<int>(order, axisSize);
     boundarySize = _boundarySize;
     boundaryOffset = std::valarray<int>(boundarySize, order);
-    coordTensor = CoordTensor<int>(order, axisSize, OUT_OF_BOUNDS);
-    for (int i = 0; i < coordTensor.GetArrayInternal().size(); i++) {
-        if (std::any_of(begin(coordTensor.CoordsFromIndex(i)), end(coordTensor.CoordsFromIndex(i)), [](const int coord) {
-            return coord < boundarySize || coord >= (axisSize - boundarySize);
-        })) {
-            continue;
-        }
-        coordTensor.GetElementDirect(i) = FREE_SPACE;
+    cropOrigin = {};
+    geometry = _geometry;
+    if (VisitGeometry(geometry, order, [](auto policy) { return decltype(policy)::order; }) != order) {
+        std::cerr << GeometryName(geometry) << " geometry is not supported for order " << order
+                  << " lattices, using CUBE instead" << std::endl;
+        geometry = GEOMETRY_CUBE;
     }
+    VisitGeometry(geometry, order, []<typename Geometry>(Geometry) {
+        adjOffsets.assign(Geometry::offsets.begin(), Geometry::offsets.end());
+    });
+    AllocateTensors();
 }
 
 void Lattice::setFlags(const bool _ignoreColors) {
     ignoreProperties = _ignoreColors;
 }
 
-void Lattice::AddModule(const Module& mod) {
+void Lattice::AddModule(Module& mod) {
     // Update coord tensor
     coordTensor[mod.coords] = mod.id;
+    mod.index = coordTensor.IndexFromCoords(mod.coords);
+    moduleCount++;
+    adjMasks.resize(moduleCount + 1);
     // Adjacency check
-#if LATTICE_RD_EDGECHECK
-    RDEdgeCheck(mod);
-#else
     EdgeCheck(mod);
-#endif
-    moduleCount++;
-    adjList.resize(moduleCount + 1);
 }
 
-void Lattice::AddBound(const std::valarray<int>& coords) {
+void Lattice::AddBound(const LatticeCoord& coords) {
     coordTensor[coords] = OUT_OF_BOUNDS;
 }
 
-void Lattice::MoveModule(Module &mod, const std::valarray<int>& offset) {
+void Lattice::Crop(const LatticeCoord& lower, const LatticeCoord& upper) {
+    const auto uncroppedTensor = std::move(coordTensor);
+    for (int i = 0; i < order; i++) {
+        axisSizes[i] = upper[i] - lower[i];
+    }
+    AllocateTensors();
+    // Copy everything that isn't free space, the border is reapplied afterward since it may have moved inward
+    for (int i = 0; i < coordTensor.Size(); i++) {
+        if (coordTensor.IsPadding(i)) continue;
+        if (const auto id = uncroppedTensor[coordTensor.CoordsFromIndex(i) + lower]; id != FREE_SPACE) {
+            coordTensor.GetElementDirect(i) = id;
+        }
+    }
+    coordTensor.SetBorder(boundarySize, OUT_OF_BOUNDS);
+    for (auto& mod : ModuleIdManager::Modules()) {
+        mod.coords -= lower;
+        mod.index = coordTensor.IndexFromCoords(mod.coords);
+    }
+    cropOrigin += lower;
+}
+
+void Lattice::MoveModule(Module &mod, const LatticeCoord& offset) {
     ClearAdjacencies(mod.id);
     coordTensor[mod.coords] = FREE_SPACE;
     mod.coords += offset;
+    mod.index = coordTensor.IndexFromCoords(mod.coords);
     coordTensor[mod.coords] = mod.id;
-#if LATTICE_RD_EDGECHECK
-    RDEdgeCheck(mod);
-#else
     EdgeCheck(mod);
-#endif
     if (!ignoreProperties) {
-        mod.properties.UpdateProperties(offset);
+        mod.properties.UpdateProperties(offset.ToValarray(order));
     }
 }
 
 bool Lattice::checkConnected() {
+    return checkConnected({});
+}
+
+bool Lattice::checkConnected(const std::vector<Module*>& detached) {
     if (moduleCount == 0) return true;
     std::vector<bool> visited(moduleCount, false);
     std::stack<int> stack;
-    int visitedCount = 0;
+    // Detached modules are reached through the static module, but nothing is reached through them
+    for (const auto mod : detached) {
+        visited[mod->id] = true;
+    }
+    int visitedCount = static_cast<int>(detached.size());
     stack.push(ModuleIdManager::MinStaticID());
     visited[ModuleIdManager::MinStaticID()] = true;
     while (!stack.empty()) {
         int node = stack.top();
         stack.pop();
         visitedCount++;
-        for (int neighbor: adjList[node]) {
-            if (!visited[neighbor]) {
+        const auto& mod = ModuleIdManager::GetModule(node);
+        for (auto mask = adjMasks[node]; mask != 0; mask &= mask - 1) {
+            if (const int neighbor = NeighborId(mod, std::countr_zero(mask)); !visited[neighbor]) {
                 visited[neighbor] = true;
                 stack.push(neighbor);
             }
@@ -104,178 +157,111 @@ bool Lattice::checkConnected() {
     return visitedCount == moduleCount;
 }
 
-void Lattice::EdgeCheck(const Module& mod) {
-    // Copy module coordinates to adjCoords
-    auto adjCoords = mod.coords;
-    for (int i = 0; i < order; i++) {
-        // Don't want to check index -1
-        if (adjCoords[i] == 0) continue;
-        adjCoords[i]--;
-        if (coordTensor[adjCoords] >= 0) {
-#if (LATTICE_VERBOSE & LAT_LOG_ADJ) == LAT_LOG_ADJ
-            DEBUG(mod << " Adjacent to " << ModuleIdManager::Modules()[coordTensor[adjCoords]] << std::endl);
-#endif
-            AddEdge(mod.id, coordTensor[adjCoords]);
-        }
-        // Don't want to check both ways if it can be avoided, also don't want to check index beyond max value
-        if (adjCoords[i] + 2 == axisSize) {
-            adjCoords[i]++;
-            continue;
-        }
-        adjCoords[i] += 2;
-        if (coordTensor[adjCoords] >= 0) {
-#if (LATTICE_VERBOSE & LAT_LOG_ADJ) == LAT_LOG_ADJ
-            DEBUG(mod << " Adjacent to " << ModuleIdManager::Modules()[coordTensor[adjCoords]] << std::endl);
-#endif
-            AddEdge(mod.id, coordTensor[adjCoords]);
-        }
-        adjCoords[i]--;
-    }
+ConnectivityResult Lattice::CheckConnectedAfterMove(const CoordTensor<int>& tensor, const LatticeCoord& origin,
+                                                    const LatticeCoord& destination, const bool localOnly) {
+    return VisitGeometry(geometry, order, [&]<typename Geometry>(Geometry) {
+        return CheckConnectedAfterMoveFor<Geometry>(tensor, origin, destination, localOnly);
+    });
 }
 
-void Lattice::RDEdgeCheck(const Module& mod) {
-    auto adjCoords = mod.coords;
-    if (adjCoords[1] != 0) {
-        // offset: 0, -1, 0
-        adjCoords[1]--;
-        if (adjCoords[0] != 0) {
-            // offset: -1, -1, 0
-            adjCoords[0]--;
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-            // offset: 1, -1, 0
-            adjCoords[0] += 2;
-        } else {
-            // offset: 1, -1, 0
-            adjCoords[0]++;
+template<typename Geometry>
+ConnectivityResult Lattice::CheckConnectedAfterMoveFor(const CoordTensor<int>& tensor, const LatticeCoord& origin,
+                                                       const LatticeCoord& destination, const bool localOnly) {
+    constexpr int order = Geometry::order;
+    constexpr int radius = LATTICE_CONNECTIVITY_RADIUS;
+    constexpr int regionSide = 2 * radius + 1;
+    // Reused between calls to avoid allocating for every check, kept per thread so checks can run concurrently
+    thread_local std::vector<LatticeCoord> targets, queue;
+    const bool moving = destination != origin;
+    const auto occupied = [&](const LatticeCoord& coords) {
+        for (int i = 0; i < order; i++) {
+            if (coords[i] < 0 || coords[i] >= axisSizes[i]) return false;
         }
-        if (adjCoords[0] != axisSize) {
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
+        if (coords == origin) return false;
+        return (moving && coords == destination) || tensor[coords] >= 0;
+    };
+    // Every part of the configuration left after removing the module touches one of its neighbors, so the configuration
+    // stays connected if its neighbors (and the module at its destination) are connected to each other
+    targets.clear();
+    for (const auto& offset : Geometry::offsets) {
+        if (occupied(origin + offset)) {
+            targets.push_back(origin + offset);
         }
-        // offset: 0, -1, 0
-        adjCoords[0]--;
-        if (adjCoords[2] != 0) {
-            // offset: 0, -1, -1
-            adjCoords[2]--;
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-            // offset: 0, -1, 1
-            adjCoords[2] += 2;
-        } else {
-            // offset: 0, -1, 1
-            adjCoords[2]++;
-        }
-        if (adjCoords[2] != axisSize) {
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-        }
-        // offset: 0, 1, 0
-        adjCoords[2]--;
-        adjCoords[1] += 2;
-    } else {
-        // offset: 0, 1, 0
-        adjCoords[1]++;
     }
-    if (adjCoords[1] != axisSize) {
-        if (adjCoords[0] != 0) {
-            // offset: -1, 1, 0
-            adjCoords[0]--;
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-            // offset: 1, 1, 0
-            adjCoords[0] += 2;
-        } else {
-            // offset: 1, 1, 0
-            adjCoords[0]++;
+    if (moving) {
+        if (std::ranges::none_of(Geometry::offsets, [&](const LatticeCoord& offset) { return occupied(destination + offset); })) {
+            return CONNECTIVITY_BROKEN;
         }
-        if (adjCoords[0] != axisSize) {
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-        }
-        // offset: 0, 1, 0
-        adjCoords[0]--;
-        if (adjCoords[2] != 0) {
-            // offset: 0, 1, -1
-            adjCoords[2]--;
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-            // offset: 0, 1, 1
-            adjCoords[2] += 2;
-        } else {
-            // offset: 0, 1, 1
-            adjCoords[2]++;
-        }
-        if (adjCoords[2] != axisSize) {
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
+        if (std::ranges::find(targets, destination) == targets.end()) {
+            targets.push_back(destination);
         }
-        // offset: 0, 0, 0
-        adjCoords[1]--;
-        adjCoords[2]--;
-    } else {
-        // offset: 0, 0, 0
-        adjCoords[1]--;
     }
-    if (adjCoords[0] != 0) {
-        // offset: -1, 0, 0
-        adjCoords[0]--;
-        if (adjCoords[2] != 0) {
-            // offset: -1, 0, -1
-            adjCoords[2]--;
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-            // offset: -1, 0, 1
-            adjCoords[2] += 2;
-        } else {
-            // offset: -1, 0, 1
-            adjCoords[2]++;
-        }
-        if (adjCoords[2] != axisSize) {
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
-            }
-        }
-        // offset: 1, 0, 0
-        adjCoords[2]--;
-        adjCoords[0] += 2;
-    } else {
-        // offset: 1, 0, 0
-        adjCoords[0]++;
+    if (targets.size() <= 1) return CONNECTIVITY_KEPT;
+    // Local searches mark cells within the region around origin, unbounded searches mark cells of the whole tensor
+    std::bitset<regionSide * regionSide * regionSide> regionVisited;
+    BitTensor tensorVisited;
+    if (!localOnly) {
+        tensorVisited = BitTensor(axisSizes);
     }
-    if (adjCoords[0] != axisSize) {
-        if (adjCoords[2] != 0) {
-            // offset: -1, 0, -1
-            adjCoords[2]--;
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
+    bool truncated = false;
+    const auto visit = [&](const LatticeCoord& coords) {
+        if (!localOnly) {
+            return !tensorVisited.TestAndSet(coords);
+        }
+        int index = 0;
+        for (int i = order - 1; i >= 0; i--) {
+            const int distance = coords[i] - origin[i];
+            if (distance < -radius || distance > radius) {
+                truncated = true;
+                return false;
             }
-            // offset: -1, 0, 1
-            adjCoords[2] += 2;
-        } else {
-            // offset: -1, 0, 1
-            adjCoords[2]++;
+            index = index * regionSide + distance + radius;
         }
-        if (adjCoords[2] != axisSize) {
-            if (coordTensor[adjCoords] >= 0) {
-                AddEdge(mod.id, coordTensor[adjCoords]);
+        if (regionVisited.test(index)) return false;
+        regionVisited.set(index);
+        return true;
+    };
+    int reached = 1;
+    queue.assign(1, targets.front());
+    visit(targets.front());
+    for (int i = 0; i < queue.size(); i++) {
+        for (const auto& offset : Geometry::offsets) {
+            const auto next = queue[i] + offset;
+            if (!occupied(next) || !visit(next)) continue;
+            if (std::ranges::find(targets, next) != targets.end() && ++reached == targets.size()) {
+                return CONNECTIVITY_KEPT;
             }
+            queue.push_back(next);
         }
     }
+    return truncated ? CONNECTIVITY_UNKNOWN : CONNECTIVITY_BROKEN;
+}
+
+void Lattice::EdgeCheck(const Module& mod) {
+    VisitGeometry(geometry, order, [&mod]<typename Geometry>(Geometry) {
+        EdgeCheckFor<Geometry>(mod);
+    });
 }
 
-void Lattice::AddEdge(const int modA, const int modB) {
-    adjList[modA].push_back(modB);
-    adjList[modB].push_back(modA);
+template<typename Geometry>
+void Lattice::EdgeCheckFor(const Module& mod) {
+    constexpr int order = Geometry::order;
+    for (int direction = 0; direction < Geometry::offsets.size(); direction++) {
+        const auto adjCoords = mod.coords + Geometry::offsets[direction];
+        // Don't want to check index -1 or any index beyond max value
+        bool inBounds = true;
+        for (int i = 0; i < order; i++) {
+            inBounds &= adjCoords[i] >= 0 && adjCoords[i] < axisSizes[i];
+        }
+        if (!inBounds) continue;
+        if (const int id = coordTensor[adjCoords]; id >= 0) {
+#if (LATTICE_VERBOSE & LAT_LOG_ADJ) == LAT_LOG_ADJ
+            DEBUG(mod << " Adjacent to " << ModuleIdManager::Modules()[id] << std::endl);
+#endif
+            adjMasks[mod.id] |= 1u << direction;
+            adjMasks[id] |= 1u << (direction ^ 1);
+        }
+    }
 }
 
 void Lattice::APUtil(const int u, std::vector<bool> &visited, std::vector<bool> &ap, std::vector<int> &parent,
@@ -286,7 +272,9 @@ void Lattice::APUtil(const int u, std::vector<bool> &visited, std::vector<bool>
     low[u] = time;
     time++;
 
-    for (const int v : adjList[u]) {
+    const auto& mod = ModuleIdManager::GetModule(u);
+    for (auto mask = adjMasks[u]; mask != 0; mask &= mask - 1) {
+        const int v = NeighborId(mod, std::countr_zero(mask));
         if (!visited[v]) {
             parent[v] = u;
             children++;
@@ -352,14 +340,14 @@ void Lattice::BuildMovableModulesNonRec() {
         std::vector<int> low(moduleCount, 0);
         int root_children = 0;
         visited[id] = true;
-        std::stack<std::tuple<int, int, std::vector<int>::const_iterator>> stack;
-        stack.emplace(id, id, adjList[id].cbegin());
+        // The last element holds the directions of the parent's neighbors that haven't been visited yet
+        std::stack<std::tuple<int, int, std::uint32_t>> stack;
+        stack.emplace(id, id, adjMasks[id]);
 
         while (!stack.empty()) {
-            if (auto [grandparent, parent, children] = stack.top(); children != adjList[parent].cend()) {
-                int child = *children;
-                ++std::get<std::vector<int>::const_iterator>(stack.top());
-                //++children;
+            if (auto [grandparent, parent, children] = stack.top(); children != 0) {
+                int child = NeighborId(ModuleIdManager::GetModule(parent), std::countr_zero(children));
+                std::get<std::uint32_t>(stack.top()) &= children - 1;
 
                 if (grandparent == child) {
                     continue;
@@ -373,7 +361,7 @@ void Lattice::BuildMovableModulesNonRec() {
                     t++;
                     low[child] = discovery[child] = t;
                     visited[child] = true;
-                    stack.emplace(parent, child, adjList[child].cbegin());
+                    stack.emplace(parent, child, adjMasks[child]);
                 }
             } else {
                 stack.pop();
@@ -400,9 +388,27 @@ void Lattice::BuildMovableModulesNonRec() {
     }
 }
 
+void Lattice::BuildMovableModulesLocal() {
+    movableModules.clear();
+    for (int id = 0; id < ModuleIdManager::MinStaticID(); id++) {
+        auto& mod = ModuleIdManager::GetModule(id);
+        const auto result = CheckConnectedAfterMove(coordTensor, mod.coords, mod.coords, true);
+        if (result == CONNECTIVITY_UNKNOWN) {
+            // One search of the whole configuration is cheaper than several unbounded local searches
+            BuildMovableModules();
+            return;
+        }
+        if (result == CONNECTIVITY_KEPT) {
+            movableModules.push_back(&mod);
+        }
+    }
+}
+
 #define AP_Recursive true
 const std::vector<Module*>& Lattice::MovableModules() {
-#if AP_Recursive
+#if LATTICE_LOCAL_CONNECTIVITY
+    BuildMovableModulesLocal();
+#elif AP_Recursive
     BuildMovableModules();
 #else
     BuildMovableModulesNonRec();
@@ -435,13 +441,11 @@ void Lattice::UpdateFromModuleInfo(const std::set<ModuleData>& moduleInfo) {
     for (const auto id : modsToMove) {
         auto& mod = ModuleIdManager::GetModule(id);
         Lattice::coordTensor[mod.coords] = FREE_SPACE;
-        mod.coords = destinations.front()->Coords();
+        // Neighbors are found by position, so adjacencies have to be cleared before the module leaves
         ClearAdjacencies(id);
-#if LATTICE_RD_EDGECHECK
-        RDEdgeCheck(mod);
-#else
+        mod.coords = destinations.front()->Coords();
+        mod.index = coordTensor.IndexFromCoords(mod.coords);
         EdgeCheck(mod);
-#endif
         Lattice::coordTensor[mod.coords] = mod.id;
         mod.properties = destinations.front()->Properties();
         destinations.pop();
@@ -465,6 +469,14 @@ int Lattice::AxisSize() {
     return axisSize;
 }
 
+const std::vector<int>& Lattice::AxisSizes() {
+    return axisSizes;
+}
+
+const std::vector<LatticeCoord>& Lattice::AdjacencyOffsets() {
+    return adjOffsets;
+}
+
 std::string Lattice::ToString() {
     std::stringstream out;
     if (order != 2) {
@@ -472,8 +484,8 @@ std::string Lattice::ToString() {
         return "";
     }
     out << "Lattice State:\n";
-    for (int i = 0; i < coordTensor.GetArrayInternal().size(); i++) {
-        if (const auto id = coordTensor.GetElementDirect(i); id >= 0 && !ignoreProperties) {
+    for (int i = 0; i < coordTensor.Size(); i++) {
+        if (const auto id = std::as_const(coordTensor).GetElementDirect(i); id >= 0 && !ignoreProperties) {
             if (ModuleIdManager::GetModule(id).moduleStatic) {
                 out << '#';
             } else {
@@ -487,7 +499,7 @@ std::string Lattice::ToString() {
         } else {
             out << "⋅";
         }
-        if ((i + 1) % axisSize == 0) {
+        if ((i + 1) % axisSizes[0] == 0) {
             out << '\n';
         }
     }
@@ -1,9 +1,12 @@
 #ifndef MODULAR_ROBOTICS_LATTICE_H
 #define MODULAR_ROBOTICS_LATTICE_H
 
+#include <cstdint>
 #include <set>
 #include "../modules/ModuleManager.h"
+#include "../coordtensor/BitTensor.h"
 #include "../coordtensor/CoordTensor.h"
+#include "LatticeGeometry.h"
 
 // Verbosity Constants (Don't change these)
 #define LAT_LOG_NONE 0
@@ -19,9 +22,38 @@
 #define LATTICE_VERBOSE LAT_LOG_NONE
 
 /* Edge Check Configuration
- * Set this to true to check for all edges of a rhombic dodecahedron instead of a cube
+ * Set this to true to check for all edges of a rhombic dodecahedron instead of a cube when a scenario doesn't specify its
+ * geometry, scenarios can select a geometry at runtime with "geometry": "CUBE", "RHOMBIC_DODECAHEDRON" or "HEXAGON"
  */
 #define LATTICE_RD_EDGECHECK false
+#define LATTICE_DEFAULT_GEOMETRY (LATTICE_RD_EDGECHECK ? GEOMETRY_RHOMBIC_DODECAHEDRON : GEOMETRY_CUBE)
+
+/* Sparse Lattice Configuration
+ * Lattices with at least this many cells (including padding) use sparse tensor storage for the lattice and the tensors
+ * derived from it, so that memory use scales with the modules present instead of the volume of the lattice. 2^20 cells
+ * is a 3rd order lattice with a little over 100 cells per axis.
+ */
+#define LATTICE_SPARSE_THRESHOLD (1 << 20)
+
+/* Morton Layout Configuration
+ * Set this to true to store 3rd order lattices in Morton (Z-order) so that neighboring cells on every axis tend to share
+ * cache lines, tensors derived from the lattice keep using linear layout
+ */
+#define LATTICE_MORTON_LAYOUT false
+
+/* Lattice Cropping Configuration
+ * Set this to true to shrink the lattice to the region that modules can reach once the initial state, final state and
+ * moves are known, each axis is cropped separately so elongated configurations no longer get a cubic lattice
+ */
+#define LATTICE_CROP_TO_REACH true
+
+/* Local Connectivity Configuration
+ * Set LATTICE_LOCAL_CONNECTIVITY to true to find movable modules by searching the region around each module (up to
+ * LATTICE_CONNECTIVITY_RADIUS cells away on every axis) for a path between its neighbors, articulation points are only
+ * searched for across the whole configuration when some local search is inconclusive
+ */
+#define LATTICE_LOCAL_CONNECTIVITY true
+#define LATTICE_CONNECTIVITY_RADIUS 2
 
 enum TensorContents {
     OUT_OF_BOUNDS = -2,
@@ -29,14 +61,24 @@ enum TensorContents {
     OCCUPIED_NO_ANCHOR = std::numeric_limits<int>::max()
 };
 
+enum ConnectivityResult {
+    CONNECTIVITY_BROKEN,
+    CONNECTIVITY_KEPT,
+    CONNECTIVITY_UNKNOWN
+};
+
 class Lattice {
 private:
-    // Vector that holds the IDs of adjacent modules, indexed by ID
-    static std::vector<std::vector<int>> adjList;
+    // Bitmask of the directions in which each module has a neighbor, indexed by ID
+    static std::vector<std::uint32_t> adjMasks;
+    // Offset to the neighbor in each direction, opposite directions are stored next to each other
+    static std::vector<LatticeCoord> adjOffsets;
     // Order of coordinate tensor / # of dimensions
     static int order;
-    // Length of every axis
+    // Length of every axis before cropping, defines the coordinate frame used by scenario files
     static int axisSize;
+    // Length of each axis of the coordinate tensor
+    static std::vector<int> axisSizes;
     // Time variable for DFS
     static int time;
     // # of modules
@@ -44,47 +86,76 @@ private:
     // Vector of movable modules
     static std::vector<Module*> movableModules;
 
-    // Clear adjacency list for module ID, and remove module ID from other lists
+    // Clear adjacency mask for module ID, and remove module ID from its neighbors' masks
     static void ClearAdjacencies(int moduleId);
 
+    // Get the ID of the neighbor of a module in a direction that is set in its adjacency mask
+    static int NeighborId(const Module& mod, int direction);
+
+    // Versions of the adjacency functions with the neighbor offsets known at compile time, instantiated for every
+    // geometry and selected using the geometry of the lattice
+    template<typename Geometry>
+    static void ClearAdjacenciesFor(int moduleId);
+
+    template<typename Geometry>
+    static void EdgeCheckFor(const Module& mod);
+
+    template<typename Geometry>
+    static ConnectivityResult CheckConnectedAfterMoveFor(const CoordTensor<int>& tensor, const LatticeCoord& origin,
+                                                         const LatticeCoord& destination, bool localOnly);
+
+    // Create empty lattice tensors using the current axis sizes
+    static void AllocateTensors();
+
 public:
-    // State tensor
-    static CoordTensor<bool> stateTensor;
     // Module tensor
     static CoordTensor<int> coordTensor;
     // Boundary Offset
     static int boundarySize;
     static std::valarray<int> boundaryOffset;
+    // Position of the coordinate tensor's origin before cropping, add to module coordinates to get scenario coordinates
+    static LatticeCoord cropOrigin;
     // Color flag
     static bool ignoreProperties;
+    // Shape of the modules, determines which cells are adjacent
+    static LatticeGeometry geometry;
 
     Lattice() = delete;
     Lattice(Lattice&) = delete;
 
     //Lattice(int order, int axisSize);
-    static void InitLattice(int _order, int _axisSize, int _boundarySize = 5);
+    static void InitLattice(int _order, int _axisSize, int _boundarySize = 5,
+                            LatticeGeometry _geometry = LATTICE_DEFAULT_GEOMETRY);
 
     static void setFlags(bool _ignoreColors);
 
     // Add a new module
-    static void AddModule(const Module& mod);
+    static void AddModule(Module& mod);
 
     // Add a new boundary
-    static void AddBound(const std::valarray<int>& coords);
+    static void AddBound(const LatticeCoord& coords);
+
+    // Shrink the lattice to the box from lower (inclusive) to upper (exclusive), the outermost boundarySize cells of the
+    // box become out of bounds. Modules are translated so that lower becomes the origin, so any module coordinates
+    // obtained before cropping are invalidated.
+    static void Crop(const LatticeCoord& lower, const LatticeCoord& upper);
 
     // Move a module
-    static void MoveModule(Module& mod, const std::valarray<int>& offset);
+    static void MoveModule(Module& mod, const LatticeCoord& offset);
 
     static bool checkConnected();
 
-    // Adjacency Check
-    static void EdgeCheck(const Module& mod);
+    // Check connectivity as if the detached modules had no neighbors other than the first static module
+    static bool checkConnected(const std::vector<Module*>& detached);
 
-    // Rhombic Dodecahedra Adjacency Check
-    static void RDEdgeCheck(const Module& mod);
+    // Check whether the configuration in tensor stays connected when the module at origin moves to destination, or when
+    // it is removed if destination is the same as origin. Local checks only search cells up to
+    // LATTICE_CONNECTIVITY_RADIUS away from origin on every axis, so their result may be unknown.
+    static ConnectivityResult CheckConnectedAfterMove(const CoordTensor<int>& tensor, const LatticeCoord& origin,
+                                                      const LatticeCoord& destination, bool localOnly);
 
-    // Update adjacency lists for two adjacent modules
-    static void AddEdge(int modA, int modB);
+    // Adjacency Check, uses the neighbors of the lattice geometry
+    static void EdgeCheck(const Module& mod);
 
     // Find articulation points / cut vertices using DFS
     static void APUtil(int u, std::vector<bool>& visited, std::vector<bool>& ap, std::vector<int>& parent, std::vector<int>& low, std::vector<int>& disc);
@@ -94,6 +165,9 @@ public:
 
     static void BuildMovableModulesNonRec();
 
+    // Build / Rebuild movableModules vector from local connectivity checks, falls back to BuildMovableModules
+    static void BuildMovableModulesLocal();
+
     // Get movable modules
     static const std::vector<Module*>& MovableModules();
 
@@ -104,12 +178,17 @@ public:
     static std::set<ModuleData> GetModuleInfo();
 
     // Assign from state tensor
-    //static void UpdateFromState(const CoordTensor<bool>& state, const CoordTensor<int>& colors);
+    //static void UpdateFromState(const BitTensor& state, const CoordTensor<int>& colors);
 
     static int Order();
 
     static int AxisSize();
 
+    static const std::vector<int>& AxisSizes();
+
+    // Get the offset to the neighbor in each direction
+    static const std::vector<LatticeCoord>& AdjacencyOffsets();
+
     static std::string ToString();
 
     friend class MoveManager;
@@ -0,0 +1,92 @@
+#ifndef MODULAR_ROBOTICS_LATTICEGEOMETRY_H
+#define MODULAR_ROBOTICS_LATTICEGEOMETRY_H
+
+#include <array>
+#include <string>
+#include "../coordtensor/Coord.h"
+
+enum LatticeGeometry {
+    GEOMETRY_CUBE,
+    GEOMETRY_RHOMBIC_DODECAHEDRON,
+    GEOMETRY_HEXAGON
+};
+
+// Neighbor offset tables for each geometry, opposite directions are always stored next to each other so that the
+// opposite of direction d is d ^ 1
+
+// Cubes on a 2nd order lattice
+struct SquareGeometry {
+    static constexpr int order = 2;
+    static constexpr std::array<LatticeCoord, 4> offsets = {{
+        {-1, 0}, {1, 0},
+        {0, -1}, {0, 1}
+    }};
+};
+
+struct CubeGeometry {
+    static constexpr int order = 3;
+    static constexpr std::array<LatticeCoord, 6> offsets = {{
+        {-1, 0, 0}, {1, 0, 0},
+        {0, -1, 0}, {0, 1, 0},
+        {0, 0, -1}, {0, 0, 1}
+    }};
+};
+
+// Rhombic dodecahedron neighbors are offset by 1 on exactly two axes
+struct RhombicDodecahedronGeometry {
+    static constexpr int order = 3;
+    static constexpr std::array<LatticeCoord, 12> offsets = {{
+        {-1, -1, 0}, {1, 1, 0}, {-1, 1, 0}, {1, -1, 0},
+        {-1, 0, -1}, {1, 0, 1}, {-1, 0, 1}, {1, 0, -1},
+        {0, -1, -1}, {0, 1, 1}, {0, -1, 1}, {0, 1, -1}
+    }};
+};
+
+// Hexagons in axial coordinates. Scenario files list (1, -1) and (-1, 1) as neighbors, the y-axis is flipped when they
+// are loaded so those become (1, 1) and (-1, -1) here.
+struct HexagonGeometry {
+    static constexpr int order = 2;
+    static constexpr std::array<LatticeCoord, 6> offsets = {{
+        {-1, 0}, {1, 0},
+        {0, -1}, {0, 1},
+        {-1, -1}, {1, 1}
+    }};
+};
+
+// Call visit with the geometry policy for a lattice, cubes use SquareGeometry on 2nd order lattices
+template<typename F>
+decltype(auto) VisitGeometry(const LatticeGeometry geometry, const int order, F&& visit) {
+    switch (geometry) {
+        case GEOMETRY_RHOMBIC_DODECAHEDRON:
+            return visit(RhombicDodecahedronGeometry{});
+        case GEOMETRY_HEXAGON:
+            return visit(HexagonGeometry{});
+        default:
+            return order == 2 ? visit(SquareGeometry{}) : visit(CubeGeometry{});
+    }
+}
+
+// Name of a geometry, as used by scenario files
+inline std::string GeometryName(const LatticeGeometry geometry) {
+    switch (geometry) {
+        case GEOMETRY_RHOMBIC_DODECAHEDRON:
+            return "RHOMBIC_DODECAHEDRON";
+        case GEOMETRY_HEXAGON:
+            return "HEXAGON";
+        default:
+            return "CUBE";
+    }
+}
+
+// Get a geometry from its name, returns false if the name is not recognized
+inline bool GeometryFromName(const std::string& name, LatticeGeometry& geometry) {
+    for (const auto candidate : {GEOMETRY_CUBE, GEOMETRY_RHOMBIC_DODECAHEDRON, GEOMETRY_HEXAGON}) {
+        if (GeometryName(candidate) == name) {
+            geometry = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif //MODULAR_ROBOTICS_LATTICEGEOMETRY_H
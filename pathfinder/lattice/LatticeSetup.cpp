@@ -5,6 +5,7 @@
 #include <iostream>
 #include <valarray>
 #include "Lattice.h"
+#include "../moves/MoveManager.h"
 #include "../search/ConfigurationSpace.h"
 #include "../modules/Metamodule.h"
 
@@ -22,11 +23,11 @@ namespace LatticeSetup {
         }
         nlohmann::json j;
         file >> j;
-        if (j.contains("tensorPadding")) {
-            Lattice::InitLattice(j["order"], j["axisSize"], j["tensorPadding"]);
-        } else {
-            Lattice::InitLattice(j["order"], j["axisSize"]);
+        LatticeGeometry geometry = LATTICE_DEFAULT_GEOMETRY;
+        if (j.contains("geometry") && !GeometryFromName(j["geometry"], geometry)) {
+            std::cerr << "Unknown geometry " << j["geometry"] << ", using " << GeometryName(geometry) << std::endl;
         }
+        Lattice::InitLattice(j["order"], j["axisSize"], j.value("tensorPadding", 5), geometry);
         std::set<int> colors;
         for (const auto& module : j["modules"]) {
             std::vector<int> position = module["position"];
@@ -54,7 +55,7 @@ namespace LatticeSetup {
                 std::cout << "Only one color used, recommend rerunning with -i flag to improve performance." << std::endl;
             }
         }
-        for (const auto& mod : ModuleIdManager::Modules()) {
+        for (auto& mod : ModuleIdManager::Modules()) {
             Lattice::AddModule(mod);
         }
         Lattice::BuildMovableModules();
@@ -96,6 +97,8 @@ namespace LatticeSetup {
 #if FLIP_Y_COORD
             coords[1] = Lattice::AxisSize() - coords[1] - 1;
 #endif
+            // The lattice may have been cropped before the final state is read
+            coords -= Lattice::cropOrigin.ToValarray(Lattice::Order());
             //desiredState[coords] = true;
             ModuleProperties props;
             if (!Lattice::ignoreProperties && module.contains("properties")) {
@@ -109,6 +112,37 @@ namespace LatticeSetup {
         return Configuration(desiredState);
     }
 
+    void cropToReach(const Configuration& finalState) {
+        // Every module stays connected to the rest of the configuration, so no module can get further from the initial
+        // and final states than the number of non-static modules, plus move checks may look a little further than that
+        auto lower = ModuleIdManager::Modules().front().coords;
+        auto upper = lower;
+        const auto include = [&lower, &upper](const LatticeCoord& coords) {
+            for (int i = 0; i < Lattice::Order(); i++) {
+                lower[i] = std::min<int>(lower[i], coords[i]);
+                upper[i] = std::max<int>(upper[i], coords[i]);
+            }
+        };
+        for (const auto& mod : ModuleIdManager::Modules()) {
+            include(mod.coords);
+        }
+        for (const auto& modData : finalState.GetModData()) {
+            include(modData.Coords());
+        }
+        const int margin = static_cast<int>(ModuleIdManager::FreeModules().size()) + MoveManager::MoveReach() + Lattice::boundarySize;
+        for (int i = 0; i < Lattice::Order(); i++) {
+            lower[i] = std::max<int>(lower[i] - margin, 0); // NOLINT(*-narrowing-conversions)
+            upper[i] = std::min<int>(upper[i] + margin + 1, Lattice::AxisSizes()[i]); // NOLINT(*-narrowing-conversions)
+        }
+        Lattice::Crop(lower, upper);
+        MoveManager::CompileMoveChecks();
+        std::cout << "Lattice cropped to";
+        for (int i = 0; i < Lattice::Order(); i++) {
+            std::cout << (i == 0 ? " " : "x") << Lattice::AxisSizes()[i];
+        }
+        std::cout << std::endl;
+    }
+
     [[deprecated("Should use setupFromJson instead")]]
     void setupInitial(const std::string& filename, int order, int axisSize) {
         Lattice::InitLattice(order, axisSize);
@@ -136,7 +170,7 @@ namespace LatticeSetup {
             y++;
         }
         ModuleIdManager::DeferredRegistration();
-        for (const auto& mod : ModuleIdManager::Modules()) {
+        for (auto& mod : ModuleIdManager::Modules()) {
             Lattice::AddModule(mod);
         }
         Lattice::BuildMovableModules();
@@ -151,14 +185,13 @@ namespace LatticeSetup {
             std::cerr << "Unable to open file " << filename << std::endl;
             throw std::ios_base::failure("Unable to open file " + filename + "\n");
         }
-        CoordTensor<bool> desiredState(Lattice::Order(), Lattice::AxisSize(), false);
-        CoordTensor<int> colors(Lattice::Order(), Lattice::AxisSize(), -1);
+        BitTensor desiredState(Lattice::AxisSizes());
+        CoordTensor<int> colors(Lattice::AxisSizes(), -1);
         std::string line;
         while (std::getline(file, line)) {
             for (char c : line) {
                 if (c == '1') {
-                    std::valarray<int> coords = {x, y};
-                    desiredState[coords] = true;
+                    desiredState.Set({x, y}, true);
                 }
                 x++;
             }
@@ -174,7 +207,7 @@ namespace LatticeSetup {
             ModuleIdManager::RegisterModule(second, first);
         }
         ModuleIdManager::DeferredRegistration();
-        for (const auto& mod : ModuleIdManager::Modules()) {
+        for (auto& mod : ModuleIdManager::Modules()) {
             Lattice::AddModule(mod);
         }
     }
@@ -186,18 +219,18 @@ namespace LatticeSetup {
                 if ((i%2==0 && j&1) || (i&1 && j%2 == 0)) {
                     for (const auto &[first, second]: MetaModuleManager::metamodules[5]->coords) {
                         std::valarray<int> newCoord = {MetaModuleManager::metamodules[5]->size * i, MetaModuleManager::metamodules[5]->size * j};
-                        ModuleIdManager::RegisterModule(second + newCoord, first);
+                        ModuleIdManager::RegisterModule(std::valarray<int>(second + newCoord), first);
                     }
                 } else {
                     for (const auto &[first, second]: MetaModuleManager::metamodules[0]->coords) {
                         std::valarray<int> newCoord = {MetaModuleManager::metamodules[0]->size * i, MetaModuleManager::metamodules[0]->size * j};
-                        ModuleIdManager::RegisterModule(second + newCoord, first);
+                        ModuleIdManager::RegisterModule(std::valarray<int>(second + newCoord), first);
                     }
                 }
             }
         }
         ModuleIdManager::DeferredRegistration();
-        for (const auto& mod : ModuleIdManager::Modules()) {
+        for (auto& mod : ModuleIdManager::Modules()) {
             Lattice::AddModule(mod);
         }
         // for (const auto &coord: MetaModuleManager::metamodules[0]->coords) {
@@ -243,12 +276,12 @@ namespace LatticeSetup {
             MetaModule* currentMetamodule = MetaModuleManager::metamodules[0];
             for (const auto &[first, second]: currentMetamodule->coords) {
                 std::valarray<int> newCoord = second + position * currentMetamodule->size;
-                ModuleIdManager::RegisterModule(second + newCoord, first);
+                ModuleIdManager::RegisterModule(std::valarray<int>(second + newCoord), first);
             }
         }
         Lattice::InitLattice(MetaModuleManager::order, MetaModuleManager::axisSize);
         ModuleIdManager::DeferredRegistration();
-        for (const auto& mod : ModuleIdManager::Modules()) {
+        for (auto& mod : ModuleIdManager::Modules()) {
             Lattice::AddModule(mod);
         }
     }
@@ -11,6 +11,10 @@ namespace LatticeSetup {
 
     Configuration setupFinalFromJson(const std::string& filename);
 
+    // Crop the lattice to the region modules can reach on the way to the final state, moves must be registered first
+    // and any configurations created beforehand are invalidated
+    void cropToReach(const Configuration& finalState);
+
     void setupInitial(const std::string& filename);
 
     Configuration setupFinal(const std::string& filename);
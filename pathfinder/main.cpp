@@ -21,9 +21,11 @@
 
 int main(int argc, char* argv[]) {
     bool ignoreColors = false;
+    bool parallelBlocks = false;
     std::string initialFile;
     std::string finalFile;
     std::string exportFile;
+    std::string planFile;
     std::string analysisFile;
     std::string searchMethod;
 
@@ -33,6 +35,8 @@ int main(int argc, char* argv[]) {
         {"initial-file", required_argument, nullptr, 'I'},
         {"final-file", required_argument, nullptr, 'F'},
         {"export-file", required_argument, nullptr, 'e'},
+        {"plan-file", required_argument, nullptr, 'p'},
+        {"parallel-blocks", no_argument, nullptr, 'b'},
         {"analysis-file", required_argument, nullptr, 'a'},
         {"search-method", required_argument, nullptr, 's'},
         {nullptr, 0, nullptr, 0}
@@ -40,7 +44,7 @@ int main(int argc, char* argv[]) {
 
     int option_index = 0;
     int c;
-    while ((c = getopt_long(argc, argv, "iI:F:e:a:s:", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "iI:F:e:p:ba:s:", long_options, &option_index)) != -1) {
         switch (c) {
             case 'i':
                 ignoreColors = true;
@@ -54,6 +58,12 @@ int main(int argc, char* argv[]) {
             case 'e':
                 exportFile = optarg;
                 break;
+            case 'p':
+                planFile = optarg;
+                break;
+            case 'b':
+                parallelBlocks = true;
+                break;
             case 'a':
                 analysisFile = optarg;
                 break;
@@ -128,11 +138,14 @@ int main(int argc, char* argv[]) {
     // Set up Lattice
     Lattice::setFlags(ignoreColors);
     LatticeSetup::setupFromJson(initialFile);
-    std::cout << Lattice::ToString();
     
     // Set up moves
     MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
     MoveManager::RegisterAllMoves("../Moves");
+#if LATTICE_CROP_TO_REACH && !GENERATE_FINAL_STATE
+    LatticeSetup::cropToReach(LatticeSetup::setupFinalFromJson(finalFile));
+#endif
+    std::cout << Lattice::ToString();
     
     // Pathfinding
     Configuration start(Lattice::GetModuleInfo());
@@ -148,6 +161,14 @@ int main(int argc, char* argv[]) {
             path = ConfigurationSpace::AStar(&start, &end);
         } else if (searchMethod == "BFS" || searchMethod == "bfs") {
             path = ConfigurationSpace::BFS(&start, &end);
+        } else if (searchMethod == "exhaustive") {
+            const auto layerCounts = ConfigurationSpace::ExhaustiveLayerCounts();
+            std::uint64_t total = 0;
+            for (int layer = 0; layer < layerCounts.size(); layer++) {
+                std::cout << "Depth " << layer << ": " << layerCounts[layer] << " states" << std::endl;
+                total += layerCounts[layer];
+            }
+            std::cout << "Reachable states: " << total << std::endl;
         }
         const auto timeEnd = std::chrono::high_resolution_clock::now();
         const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeBegin);
@@ -159,6 +180,12 @@ int main(int argc, char* argv[]) {
         std::cerr << bfsExcept.what() << std::endl;
     }
 
+    // Exhaustive search only counts states, there's no path to export
+    if (searchMethod == "exhaustive") {
+        Isometry::CleanupTransforms();
+        return 0;
+    }
+
 #if PRINT_PATH
     std::cout << "Path:\n";
     for (const auto config : path) {
@@ -171,6 +198,8 @@ int main(int argc, char* argv[]) {
     scenInfo.exportFile = exportFile;
     scenInfo.scenName = Scenario::TryGetScenName(initialFile);
     scenInfo.scenDesc = Scenario::TryGetScenDesc(initialFile);
+    scenInfo.parallelBlocks = parallelBlocks;
+    scenInfo.planFile = planFile;
     
     Scenario::exportToScen(path, scenInfo);
     Isometry::CleanupTransforms();
@@ -5,12 +5,12 @@
 
 
 
-ModuleBasic::ModuleBasic(const std::valarray<int>& coords, const ModuleProperties& properties) : coords(coords), properties(properties) {
+ModuleBasic::ModuleBasic(const LatticeCoord& coords, const ModuleProperties& properties) : coords(coords), properties(properties) {
     constexpr std::hash<ModuleBasic> hasher;
     hasher(*this);
 }
 
-const std::valarray<int>& ModuleBasic::Coords() const {
+LatticeCoord ModuleBasic::Coords() const {
     return coords;
 }
 
@@ -20,15 +20,7 @@ const ModuleProperties& ModuleBasic::Properties() const {
 
 bool ModuleBasic::operator==(const IModuleBasic& right) const {
     const auto r = reinterpret_cast<const ModuleBasic&>(right);
-    if (coords.size() != r.coords.size()) {
-        return false;
-    }
-    for (int i = 0; i < coords.size(); i++) {
-        if (coords[i] != r.coords[i]) {
-            return false;
-        }
-    }
-    return properties == r.properties;
+    return coords == r.coords && properties == r.properties;
 }
 
 bool ModuleBasic::operator<(const IModuleBasic& right) const {
@@ -38,9 +30,7 @@ bool ModuleBasic::operator<(const IModuleBasic& right) const {
 
 std::unordered_map<std::uint_fast64_t, ModuleProperties> ModuleInt64::propertyMap;
 
-std::unordered_map<std::uint_fast64_t, std::valarray<int>> ModuleInt64::coordMap;
-
-ModuleInt64::ModuleInt64(const std::valarray<int> &coords, const ModuleProperties &properties) {
+ModuleInt64::ModuleInt64(const LatticeCoord& coords, const ModuleProperties &properties) {
     constexpr std::uint_fast64_t propertyMask = 0xFFFFFFFFFF000000;
     modInt = 0;
     for (int i = 0; i < coords.size(); i++) {
@@ -52,15 +42,12 @@ ModuleInt64::ModuleInt64(const std::valarray<int> &coords, const ModulePropertie
     }
 }
 
-const std::valarray<int>& ModuleInt64::Coords() const {
-    constexpr std::uint_fast64_t coordMask = 0x0000000000FFFFFF;
-    if (!coordMap.contains(modInt & coordMask)) {
-        coordMap[modInt & coordMask] = std::valarray<int>(0, Lattice::Order());
-        for (int i = 0; i < Lattice::Order(); i++) {
-            coordMap[modInt & coordMask][i] = (modInt >> (i * 8)) & 0xFF; // NOLINT(*-narrowing-conversions) (Mask should handle it)
-        }
+LatticeCoord ModuleInt64::Coords() const {
+    LatticeCoord coords;
+    for (int i = 0; i < Lattice::Order(); i++) {
+        coords[i] = (modInt >> (i * 8)) & 0xFF; // NOLINT(*-narrowing-conversions) (Mask should handle it)
     }
-    return coordMap[modInt & coordMask];
+    return coords;
 }
 
 const ModuleProperties& ModuleInt64::Properties() const {
@@ -87,7 +74,7 @@ ModuleData::ModuleData(const ModuleData &modData) {
 }
 
 
-ModuleData::ModuleData(const std::valarray<int> &coords, const ModuleProperties &properties) {
+ModuleData::ModuleData(const LatticeCoord& coords, const ModuleProperties &properties) {
 #if CONFIG_MOD_DATA_STORAGE == MM_DATA_FULL
     module = std::make_unique<ModuleBasic>(coords, properties);
 #else
@@ -95,7 +82,7 @@ ModuleData::ModuleData(const std::valarray<int> &coords, const ModuleProperties
 #endif
 }
 
-const std::valarray<int>& ModuleData::Coords() const {
+LatticeCoord ModuleData::Coords() const {
     return module->Coords();
 }
 
@@ -138,7 +125,8 @@ std::size_t std::hash<ModuleBasic>::operator()(ModuleBasic& modData) const noexc
 }
 
 std::size_t boost::hash<ModuleBasic>::operator()(const ModuleBasic& modData) const noexcept {
-    auto coordHash = boost::hash_range(begin(modData.Coords()), end(modData.Coords()));
+    const auto coords = modData.Coords();
+    auto coordHash = boost::hash_range(coords.begin(), coords.begin() + Lattice::Order());
     if (!Lattice::ignoreProperties) {
         constexpr boost::hash<ModuleProperties> propertyHasher;
         const auto propertyHash = propertyHasher(modData.Properties());
@@ -149,12 +137,13 @@ std::size_t boost::hash<ModuleBasic>::operator()(const ModuleBasic& modData) con
 
 Module::Module(Module&& mod) noexcept {
     coords = mod.coords;
+    index = mod.index;
     moduleStatic = mod.moduleStatic;
     properties = mod.properties;
     id = mod.id;
 }
 
-Module::Module(const std::valarray<int>& coords, const bool isStatic, const nlohmann::basic_json<>& propertyDefs) : coords(coords), moduleStatic(isStatic), id(ModuleIdManager::GetNextId()) {
+Module::Module(const LatticeCoord& coords, const bool isStatic, const nlohmann::basic_json<>& propertyDefs) : coords(coords), moduleStatic(isStatic), id(ModuleIdManager::GetNextId()) {
     properties.InitProperties(propertyDefs);
 }
 
@@ -163,7 +152,7 @@ std::vector<DeferredModCnstrArgs> ModuleIdManager::_deferredInitMods;
 std::vector<Module> ModuleIdManager::_modules;
 int ModuleIdManager::_staticStart = 0;
 
-void ModuleIdManager::RegisterModule(const std::valarray<int>& coords, bool isStatic, const nlohmann::basic_json<>& propertyDefs, const bool deferred) {
+void ModuleIdManager::RegisterModule(const LatticeCoord& coords, bool isStatic, const nlohmann::basic_json<>& propertyDefs, const bool deferred) {
     if (!deferred && isStatic) {
         DeferredModCnstrArgs args;
         args.coords = coords;
@@ -213,8 +202,8 @@ int ModuleIdManager::MinStaticID() {
 std::ostream& operator<<(std::ostream& out, const Module& mod) {
     out << "Module with ID " << mod.id << " at ";
     std::string sep = "(";
-    for (const auto coord : mod.coords) {
-        out << sep << coord;
+    for (int i = 0; i < Lattice::Order(); i++) {
+        out << sep << mod.coords[i];
         sep = ", ";
     }
     out << ")";
@@ -8,6 +8,7 @@
 #include <valarray>
 #include <nlohmann/json.hpp>
 #include "ModuleProperties.h"
+#include "../coordtensor/Coord.h"
 
 // Module Data Storage Constants (Don't change these)
 #define MM_DATA_FULL 0
@@ -25,7 +26,7 @@
 class IModuleBasic {
 public:
     [[nodiscard]]
-    virtual const std::valarray<int>& Coords() const = 0;
+    virtual LatticeCoord Coords() const = 0;
 
     [[nodiscard]]
     virtual const ModuleProperties& Properties() const = 0;
@@ -45,10 +46,10 @@ private:
 public:
     ModuleData(const ModuleData& modData);
 
-    ModuleData(const std::valarray<int>& coords, const ModuleProperties& properties);
+    ModuleData(const LatticeCoord& coords, const ModuleProperties& properties);
 
     [[nodiscard]]
-    const std::valarray<int>& Coords() const override;
+    LatticeCoord Coords() const override;
 
     [[nodiscard]]
     const ModuleProperties& Properties() const override;
@@ -67,16 +68,16 @@ private:
 
     bool hashCacheValid = false;
 
-    std::valarray<int> coords;
+    LatticeCoord coords;
 
     ModuleProperties properties;
 
 public:
     ModuleBasic() = default;
 
-    ModuleBasic(const std::valarray<int>& coords, const ModuleProperties& properties);
+    ModuleBasic(const LatticeCoord& coords, const ModuleProperties& properties);
 
-    const std::valarray<int>& Coords() const override;
+    LatticeCoord Coords() const override;
 
     const ModuleProperties& Properties() const override;
 
@@ -95,13 +96,12 @@ private:
     std::uint_fast64_t modInt;
 
     static std::unordered_map<std::uint_fast64_t, ModuleProperties> propertyMap;
-
-    static std::unordered_map<std::uint_fast64_t, std::valarray<int>> coordMap;
 public:
-    ModuleInt64(const std::valarray<int>& coords, const ModuleProperties& properties);
+    ModuleInt64(const LatticeCoord& coords, const ModuleProperties& properties);
 
+    // Coordinates are unpacked directly from the integer representation
     [[nodiscard]]
-    const std::valarray<int>& Coords() const override;
+    LatticeCoord Coords() const override;
 
     [[nodiscard]]
     const ModuleProperties& Properties() const override;
@@ -137,7 +137,9 @@ struct boost::hash<ModuleBasic> {
 class Module {
 public:
     // Coordinate information
-    std::valarray<int> coords;
+    LatticeCoord coords;
+    // Index of the module's cell in the lattice's coordinate tensor, kept up to date by the lattice
+    int index = 0;
     // Static module check
     bool moduleStatic = false;
     // Properties
@@ -147,11 +149,11 @@ public:
 
     Module(Module&& mod) noexcept;
 
-    explicit Module(const std::valarray<int>& coords, bool isStatic = false, const nlohmann::basic_json<>& propertyDefs = {});
+    explicit Module(const LatticeCoord& coords, bool isStatic = false, const nlohmann::basic_json<>& propertyDefs = {});
 };
 
 struct DeferredModCnstrArgs {
-    std::valarray<int> coords;
+    LatticeCoord coords;
     bool isStatic;
     nlohmann::basic_json<> propertyDefs;
 };
@@ -174,7 +176,7 @@ public:
     ModuleIdManager(const ModuleIdManager&) = delete;
 
     // Register a new module
-    static void RegisterModule(const std::valarray<int>& coords, bool isStatic, const nlohmann::basic_json<>& propertyDefs = {}, bool deferred = false);
+    static void RegisterModule(const LatticeCoord& coords, bool isStatic, const nlohmann::basic_json<>& propertyDefs = {}, bool deferred = false);
 
     // Register static modules after non-static modules
     static void DeferredRegistration();
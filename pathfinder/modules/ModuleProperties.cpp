@@ -185,6 +185,10 @@ std::uint_fast64_t ModuleProperties::AsInt() const {
     exit(1);
 }
 
+bool ModuleProperties::HasDynamicProperties() const {
+    return !_dynamicProperties.empty();
+}
+
 ModuleProperties::~ModuleProperties() {
     for (const auto property : _properties) {
         delete property;
@@ -91,6 +91,10 @@ public:
     [[nodiscard]]
     std::uint_fast64_t AsInt() const;
 
+    // Check if any property may change when the module moves
+    [[nodiscard]]
+    bool HasDynamicProperties() const;
+
     ~ModuleProperties();
 
     friend class IModuleProperty;
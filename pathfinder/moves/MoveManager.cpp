@@ -2,8 +2,18 @@
 #include <fstream>
 #include <filesystem>
 #include <execution>
+#include <bit>
+#include <numeric>
+#include <sstream>
+#include <boost/functional/hash.hpp>
 #include "MoveManager.h"
 #include "../search/ConfigurationSpace.h"
+#if MOVEMANAGER_MOVE_LIBRARY_CACHE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 void Move::RotateAnim(Move::AnimType& anim, const int a, const int b) {
     // For easily rotating move types
@@ -69,8 +79,18 @@ void Move::RotateAnim(Move::AnimType& anim, const int a, const int b) {
     }
 }
 
-bool MoveBase::FreeSpaceCheck(const CoordTensor<int>& tensor, const std::valarray<int> &coords) {
-    return std::all_of(std::execution::par_unseq, moves.begin(), moves.end(), [&coords = std::as_const(coords), &tensor = std::as_const(tensor)](auto& move) {
+bool MoveBase::FreeSpaceCheck(const CoordTensor<int>& tensor, const LatticeCoord& coords) {
+    if (HasIndexOffsets() && MoveManager::IndexOffsetsApply(tensor)) {
+        const int* cell = tensor.GetArrayInternal().data() + tensor.IndexFromCoords(coords);
+        for (int i = 0; i < moves.size(); i++) {
+            const int id = cell[indexOffsets[i]];
+            if (moves[i].second ? id == OUT_OF_BOUNDS : id > FREE_SPACE) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return std::all_of(std::execution::seq, moves.begin(), moves.end(), [&coords = std::as_const(coords), &tensor = std::as_const(tensor)](auto& move) {
         if (!move.second && (tensor[coords + move.first] > FREE_SPACE)) {
             return false;
         }
@@ -81,22 +101,23 @@ bool MoveBase::FreeSpaceCheck(const CoordTensor<int>& tensor, const std::valarra
     });
 }
 
-int GetChebyshevDistance(const std::valarray<int>& a, const std::valarray<int>& b) {
-    std::valarray dist = a + b;
-    return *std::ranges::max_element(dist);
+int GetChebyshevDistance(const LatticeCoord& a, const LatticeCoord& b) {
+    const auto dist = a + b;
+    return *std::max_element(dist.begin(), dist.begin() + Lattice::Order());
 }
 
-int GetManhattanDistance(const std::valarray<int>& a, const std::valarray<int>& b) {
+int GetManhattanDistance(const LatticeCoord& a, const LatticeCoord& b) {
+    const auto dist = a + b;
     int result = 0;
-    for (auto val : std::valarray<int>(a + b)) {
-        result += std::abs(val);
+    for (int i = 0; i < Lattice::Order(); i++) {
+        result += std::abs(dist[i]);
     }
     return result;
 }
 
-bool MoveBase::FreeSpaceCheckHelpLimit(const CoordTensor<int>& tensor, const std::valarray<int>& coords, const CoordTensor<int>& helpTensor, int help) {
+bool MoveBase::FreeSpaceCheckHelpLimit(const CoordTensor<int>& tensor, const LatticeCoord& coords, const CoordTensor<int>& helpTensor, int help) {
     int helpUsed = 0;
-    std::vector<std::valarray<int>*> helperPositions;
+    std::vector<LatticeCoord*> helperPositions;
     return std::all_of(std::execution::seq, moves.begin(), moves.end(), [&](auto& move) {
         if (!move.second && (tensor[coords + move.first] > FREE_SPACE)) {
             return false;
@@ -106,11 +127,11 @@ bool MoveBase::FreeSpaceCheckHelpLimit(const CoordTensor<int>& tensor, const std
             if (helpUsed == 0) {
                 helpUsed = helpTensor[coords + move.first];
             } else for (const auto pos : helperPositions) {
-#if LATTICE_RD_EDGECHECK
-                minHelpNeeded = std::min(helpTensor[coords + move.first], GetChebyshevDistance(move.first, *pos));
-#else
-                minHelpNeeded = std::min(helpTensor[coords + move.first], GetManhattanDistance(move.first, *pos));
-#endif
+                if (Lattice::geometry == GEOMETRY_RHOMBIC_DODECAHEDRON) {
+                    minHelpNeeded = std::min(helpTensor[coords + move.first], GetChebyshevDistance(move.first, *pos));
+                } else {
+                    minHelpNeeded = std::min(helpTensor[coords + move.first], GetManhattanDistance(move.first, *pos));
+                }
             }
             helpUsed += minHelpNeeded;
             helperPositions.push_back(&move.first);
@@ -123,6 +144,18 @@ bool MoveBase::FreeSpaceCheckHelpLimit(const CoordTensor<int>& tensor, const std
     });
 }
 
+void MoveBase::CompileIndexOffsets(const CoordTensor<int>& tensor) {
+    indexOffsets.clear();
+    if (tensor.Storage() != TENSOR_DENSE || tensor.Layout() != TENSOR_LINEAR) return;
+    for (const auto& [offset, check] : moves) {
+        indexOffsets.push_back(tensor.IndexOffset(offset));
+    }
+}
+
+bool MoveBase::HasIndexOffsets() const {
+    return !indexOffsets.empty();
+}
+
 void MoveBase::Rotate(const int a, const int b) {
     std::swap(initPos[a], initPos[b]);
     std::swap(finalPos[a], finalPos[b]);
@@ -149,36 +182,45 @@ void MoveBase::Reflect(const int index) {
     }
 }
 
-const std::valarray<int>& MoveBase::MoveOffset() const {
+const LatticeCoord& MoveBase::MoveOffset() const {
     return finalPos;
 }
 
+int MoveBase::Id() const {
+    return id;
+}
+
+float MoveBase::Cost() const {
+    return cost;
+}
+
 const std::vector<std::pair<Move::AnimType, std::valarray<int>>>& MoveBase::AnimSequence() const {
     return animSequence;
 }
 
+std::vector<std::pair<LatticeCoord, bool>> MoveBase::SortedChecks() const {
+    auto checks = moves;
+    std::ranges::sort(checks);
+    return checks;
+}
+
+std::size_t MoveBase::CanonicalHash() const {
+    std::size_t hash = boost::hash_range(finalPos.begin(), finalPos.end());
+    for (const auto& [offset, check] : SortedChecks()) {
+        boost::hash_combine(hash, boost::hash_range(offset.begin(), offset.end()));
+        boost::hash_combine(hash, check);
+    }
+    return hash;
+}
+
 bool MoveBase::operator==(const MoveBase &rhs) const {
-    std::valarray valArrComparison = finalPos == rhs.finalPos;
-    for (const auto result : valArrComparison) {
-        if (!result) {
-            return false;
-        }
+    if (finalPos != rhs.finalPos) {
+        return false;
     }
     if (moves.size() != rhs.moves.size()) {
         return false;
     }
-    for (auto it = moves.begin(), it2 = rhs.moves.begin(); it != moves.end(); ++it, ++it2) {
-        valArrComparison = it->first == it2->first;
-        for (const auto result : valArrComparison) {
-            if (!result) {
-                return false;
-            }
-        }
-        if (it->second != it->second) {
-            return false;
-        }
-    }
-    return true;
+    return SortedChecks() == rhs.SortedChecks();
 }
 
 
@@ -195,7 +237,7 @@ MoveBase* Move2d::MakeCopy() const {
 
 void Move2d::InitMove(const nlohmann::basic_json<>& moveDef) {
     int x = 0, y = 0;
-    std::valarray<int> maxBounds = {0, 0};
+    LatticeCoord maxBounds;
     for (const std::string line : moveDef["def"][0]) {
         for (const char c : line) {
             switch (c) {
@@ -241,6 +283,7 @@ void Move2d::InitMove(const nlohmann::basic_json<>& moveDef) {
     maxBounds -= initPos;
     bounds[0].second = maxBounds[0];
     bounds[1].second = maxBounds[1];
+    cost = moveDef.value("cost", 1.0f);
     // Set up animation data
     for (const auto& animDef : moveDef["animSeq"]) {
         Move::AnimType animType = Move::StrAnimMap.at(animDef[0]);
@@ -259,13 +302,13 @@ bool Move2d::MoveCheck(const CoordTensor<int>& tensor, const Module& mod) {
     // Bounds checking
 #if MOVEMANAGER_BOUNDS_CHECKS
     for (int i = 0; i < order; i++) {
-        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= Lattice::AxisSize()) {
+        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= Lattice::AxisSizes()[i]) {
             return false;
         }
     }
 #endif
     // Move Check
-    return std::all_of(std::execution::par_unseq, moves.begin(), moves.end(), [&mod = std::as_const(mod), &tensor = std::as_const(tensor)](auto& move) {
+    return std::all_of(std::execution::seq, moves.begin(), moves.end(), [&mod = std::as_const(mod), &tensor = std::as_const(tensor)](auto& move) {
         if ((tensor[mod.coords + move.first] < 0) == move.second) {
             return false;
         }
@@ -286,7 +329,7 @@ MoveBase* Move3d::MakeCopy() const {
 
 void Move3d::InitMove(const nlohmann::basic_json<>& moveDef) {
     int x = 0, y = 0, z = 0;
-    std::valarray<int> maxBounds = {0, 0, 0};
+    LatticeCoord maxBounds;
     for (const std::vector<std::string> slice : moveDef["def"]) {
         for (const auto& line : slice) {
             for (const auto c: line) {
@@ -342,6 +385,7 @@ void Move3d::InitMove(const nlohmann::basic_json<>& moveDef) {
     bounds[0].second = maxBounds[0];
     bounds[1].second = maxBounds[1];
     bounds[2].second = maxBounds[2];
+    cost = moveDef.value("cost", 1.0f);
     // Set up animation data
     if (moveDef.contains("animSeq") == true) {
         for (const auto& animDef : moveDef["animSeq"]) {
@@ -362,13 +406,13 @@ bool Move3d::MoveCheck(const CoordTensor<int> &tensor, const Module &mod) {
     // Bounds checking
 #if MOVEMANAGER_BOUNDS_CHECKS
     for (int i = 0; i < order; i++) {
-        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= tensor.AxisSize()) {
+        if (mod.coords[i] - bounds[i].first < 0 || mod.coords[i] + bounds[i].second >= tensor.AxisSize(i)) {
             return false;
         }
     }
 #endif
     // Move Check
-    return std::all_of(std::execution::par_unseq, moves.begin(), moves.end(), [&mod = std::as_const(mod), &tensor = std::as_const(tensor)](auto& move) {
+    return std::all_of(std::execution::seq, moves.begin(), moves.end(), [&mod = std::as_const(mod), &tensor = std::as_const(tensor)](auto& move) {
         if ((tensor[mod.coords + move.first] < 0) == move.second) {
             return false;
         }
@@ -378,7 +422,16 @@ bool Move3d::MoveCheck(const CoordTensor<int> &tensor, const Module &mod) {
 
 std::vector<MoveBase*> MoveManager::_moves;
 CoordTensor<std::vector<MoveBase*>> MoveManager::_movesByOffset(1, 1, {});
-std::vector<std::valarray<int>> MoveManager::_offsets;
+std::vector<LatticeCoord> MoveManager::_offsets;
+std::vector<int> MoveManager::_indexAxisSizes;
+std::vector<LatticeCoord> MoveManager::_stencil;
+std::vector<int> MoveManager::_stencilIndexOffsets;
+std::vector<int> MoveManager::_offsetStencilIndices;
+std::vector<std::vector<MoveBase*>> MoveManager::_legalMoves;
+std::vector<bool> MoveManager::_legalMovesValid;
+float MoveManager::_minMoveCost = 1;
+bool MoveManager::_uniformMoveCosts = true;
+std::unordered_map<std::size_t, std::vector<MoveBase*>> MoveManager::_movesByHash;
 
 void MoveManager::InitMoveManager(const int order, const int maxDistance) {
     _movesByOffset = std::move(CoordTensor<std::vector<MoveBase*>>(order, 2 * maxDistance,
@@ -392,11 +445,7 @@ void MoveManager::GenerateMovesFrom(MoveBase* origMove) {
     int dupesAvoided = 0;
 #endif
     for (const auto move: list) {
-        if (std::none_of(_moves.begin(), _moves.end(), [&move](auto& existingMove) {
-            return *existingMove == *dynamic_cast<MoveBase*>(move);
-        })) {
-            _moves.push_back(dynamic_cast<MoveBase*>(move));
-        } else {
+        if (!AddUniqueMove(dynamic_cast<MoveBase*>(move))) {
 #if MOVEMANAGER_VERBOSE > MM_LOG_NONE
             dupesAvoided++;
 #endif
@@ -406,20 +455,244 @@ void MoveManager::GenerateMovesFrom(MoveBase* origMove) {
     DEBUG("Registered " << list.size() - dupesAvoided << '/' << list.size() << " generated moves." << std::endl);
     DEBUG("Duplicate moves avoided: " << dupesAvoided << std::endl);
 #endif
-    // Add move to offset map
-    for (auto move : _moves) {
+}
+
+void MoveManager::RegisterSingleMove(MoveBase *move) {
+    AddUniqueMove(move);
+}
+
+bool MoveManager::AddUniqueMove(MoveBase* move) {
+    auto& sameHash = _movesByHash[move->CanonicalHash()];
+    if (const auto existing = std::ranges::find_if(sameHash, [move](const MoveBase* existingMove) {
+        return *existingMove == *move;
+    }); existing != sameHash.end()) {
+        // Keep the cheapest cost given for the same move
+        (*existing)->cost = std::min((*existing)->cost, move->cost);
+        return false;
+    }
+    sameHash.push_back(move);
+    move->id = static_cast<int>(_moves.size());
+    _moves.push_back(move);
+    return true;
+}
+
+#if MOVEMANAGER_MOVE_LIBRARY_CACHE
+namespace {
+    // Move libraries are arrays of 32-bit words. The header is the magic number, the format version, the key split into
+    // two words and the number of moves. Each move is then stored as its order, check count and animation count, its
+    // cost as float bits, its initial and final positions, a (first, second) pair of bounds for each axis, an (x, y, z, occupied) entry for each
+    // check and a (type, size, offsets...) entry for each animation step.
+    constexpr std::uint32_t MOVE_LIBRARY_MAGIC = 0x4C564F4D;
+    constexpr std::uint32_t MOVE_LIBRARY_VERSION = 2;
+    constexpr int MOVE_LIBRARY_HEADER_WORDS = 5;
+    // Size of a move with no checks or animation steps, for a 2nd order lattice
+    constexpr int MOVE_LIBRARY_MIN_MOVE_WORDS = 14;
+}
+
+std::uint64_t MoveManager::MoveLibraryKey(const std::string& movePath) {
+    std::vector<std::filesystem::path> moveFiles;
+    for (const auto& moveFile : std::filesystem::recursive_directory_iterator(movePath)) {
+        if (moveFile.is_regular_file()) {
+            moveFiles.push_back(moveFile.path());
+        }
+    }
+    std::ranges::sort(moveFiles);
+    std::size_t key = MOVE_LIBRARY_VERSION;
+    boost::hash_combine(key, Lattice::Order());
+    boost::hash_combine(key, static_cast<int>(Lattice::geometry));
+    for (const auto& moveFile : moveFiles) {
+        std::stringstream contents;
+        contents << std::ifstream(moveFile).rdbuf();
+        boost::hash_combine(key, std::filesystem::relative(moveFile, movePath).string());
+        boost::hash_combine(key, contents.str());
+    }
+    return key;
+}
+
+bool MoveManager::LoadMoveLibrary(const std::string& libraryPath, const std::uint64_t key) {
+    const int file = open(libraryPath.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat fileInfo = {};
+    if (fstat(file, &fileInfo) != 0 || fileInfo.st_size < MOVE_LIBRARY_HEADER_WORDS * sizeof(std::uint32_t)) {
+        close(file);
+        return false;
+    }
+    const auto size = static_cast<std::size_t>(fileInfo.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED) return false;
+    const auto words = static_cast<const std::int32_t*>(mapping);
+    const std::size_t wordCount = size / sizeof(std::int32_t);
+    std::size_t pos = 0;
+    // Every read is bounds checked, a truncated library is treated the same as a missing one
+    bool valid = true;
+    const auto next = [&]() {
+        if (pos >= wordCount) {
+            valid = false;
+            return 0;
+        }
+        return words[pos++];
+    };
+    valid = static_cast<std::uint32_t>(next()) == MOVE_LIBRARY_MAGIC
+            && static_cast<std::uint32_t>(next()) == MOVE_LIBRARY_VERSION;
+    const std::uint64_t storedKey = static_cast<std::uint32_t>(next());
+    valid = valid && (storedKey | static_cast<std::uint64_t>(static_cast<std::uint32_t>(next())) << 32) == key;
+    // Counts are checked against the words left before anything is sized from them, so a corrupt library can't request
+    // a huge allocation
+    const auto remaining = [&](const int count, const std::size_t wordsEach) {
+        return count >= 0 && static_cast<std::size_t>(count) * wordsEach <= wordCount - pos;
+    };
+    const int moveCount = next();
+    valid = valid && remaining(moveCount, MOVE_LIBRARY_MIN_MOVE_WORDS);
+    std::vector<MoveBase*> loaded;
+    for (int i = 0; valid && i < moveCount; i++) {
+        const int order = next();
+        const int checkCount = next();
+        const int animCount = next();
+        if (order != Lattice::Order() || !remaining(checkCount, 4) || !remaining(animCount, 2)) {
+            valid = false;
+            break;
+        }
+        MoveBase* move = order == 2 ? static_cast<MoveBase*>(new Move2d()) : new Move3d();
+        loaded.push_back(move);
+        move->cost = std::bit_cast<float>(next());
+        for (int j = 0; j < 3; j++) {
+            move->initPos[j] = static_cast<std::int16_t>(next());
+        }
+        for (int j = 0; j < 3; j++) {
+            move->finalPos[j] = static_cast<std::int16_t>(next());
+        }
+        for (auto& [first, second] : move->bounds) {
+            first = next();
+            second = next();
+        }
+        for (int j = 0; valid && j < checkCount; j++) {
+            const int x = next(), y = next(), z = next();
+            move->moves.emplace_back(LatticeCoord{x, y, z}, next() != 0);
+        }
+        for (int j = 0; valid && j < animCount; j++) {
+            const auto type = static_cast<Move::AnimType>(next());
+            const int offsetSize = next();
+            if (offsetSize < 0 || offsetSize > 3 || !remaining(offsetSize, 1)) {
+                valid = false;
+                break;
+            }
+            std::valarray<int> offset(offsetSize);
+            for (auto& component : offset) {
+                component = next();
+            }
+            move->animSequence.emplace_back(type, offset);
+        }
+    }
+    munmap(mapping, size);
+    if (!valid) {
+        for (const auto move : loaded) {
+            delete move;
+        }
+        return false;
+    }
+    for (const auto move : loaded) {
+        Isometry::transformsToFree.push_back(move);
+        AddUniqueMove(move);
+    }
+#if MOVEMANAGER_VERBOSE > MM_LOG_NONE
+    DEBUG("Loaded " << loaded.size() << " moves from move library " << libraryPath << std::endl);
+#endif
+    return true;
+}
+
+void MoveManager::SaveMoveLibrary(const std::string& libraryPath, const std::uint64_t key) {
+    std::vector<std::int32_t> words = {
+        static_cast<std::int32_t>(MOVE_LIBRARY_MAGIC),
+        static_cast<std::int32_t>(MOVE_LIBRARY_VERSION),
+        static_cast<std::int32_t>(key & 0xFFFFFFFF),
+        static_cast<std::int32_t>(key >> 32),
+        static_cast<std::int32_t>(_moves.size())
+    };
+    for (const auto move : _moves) {
+        words.push_back(move->order);
+        words.push_back(static_cast<std::int32_t>(move->moves.size()));
+        words.push_back(static_cast<std::int32_t>(move->animSequence.size()));
+        words.push_back(std::bit_cast<std::int32_t>(move->cost));
+        for (int j = 0; j < 3; j++) {
+            words.push_back(move->initPos[j]);
+        }
+        for (int j = 0; j < 3; j++) {
+            words.push_back(move->finalPos[j]);
+        }
+        for (const auto& [first, second] : move->bounds) {
+            words.push_back(first);
+            words.push_back(second);
+        }
+        for (const auto& [offset, check] : move->moves) {
+            words.insert(words.end(), {offset[0], offset[1], offset[2], static_cast<std::int32_t>(check)});
+        }
+        for (const auto& [type, offset] : move->animSequence) {
+            words.push_back(type);
+            words.push_back(static_cast<std::int32_t>(offset.size()));
+            words.insert(words.end(), std::begin(offset), std::end(offset));
+        }
+    }
+    // Written to a temporary file first so that concurrent runs never see a partially written library
+    std::error_code error;
+    const std::filesystem::path path = libraryPath;
+    std::filesystem::create_directories(path.parent_path(), error);
+    const auto tempPath = path.string() + "." + std::to_string(getpid()) + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(std::int32_t)));
+        if (!file) {
+            file.close();
+            std::filesystem::remove(tempPath, error);
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+    }
+}
+#endif
+
+void MoveManager::BuildOffsetIndex() {
+    for (const auto& offset : _offsets) {
+        _movesByOffset[offset].clear();
+    }
+    _offsets.clear();
+    for (const auto move : _moves) {
         if (_movesByOffset[move->finalPos].empty()) {
             _offsets.push_back(move->finalPos);
         }
         _movesByOffset[move->finalPos].push_back(move);
     }
-}
-
-void MoveManager::RegisterSingleMove(MoveBase *move) {
-    _moves.push_back(move);
+    // CheckAllMoves takes the first possible move for each offset, so cheaper moves have to be checked first
+    for (const auto& offset : _offsets) {
+        std::ranges::stable_sort(_movesByOffset[offset], {}, &MoveBase::cost);
+    }
+    _minMoveCost = _moves.empty() ? 1 : std::ranges::min(_moves, {}, &MoveBase::cost)->cost;
+    _uniformMoveCosts = std::ranges::all_of(_moves, [](const MoveBase* move) { return move->cost == _minMoveCost; });
+#if MOVEMANAGER_VERBOSE > MM_LOG_NONE
+    std::cout << "Registered " << _moves.size() << " unique moves over " << _offsets.size() << " offsets" << std::endl;
+    for (const auto& offset : _offsets) {
+        std::cout << "  (" << offset[0] << ", " << offset[1] << ", " << offset[2] << "): "
+                  << _movesByOffset[offset].size() << " moves" << std::endl;
+    }
+#endif
 }
 
 void MoveManager::RegisterAllMoves(const std::string& movePath) {
+#if MOVEMANAGER_MOVE_LIBRARY_CACHE
+    const auto key = MoveLibraryKey(movePath);
+    std::stringstream libraryName;
+    libraryName << "moves_" << std::hex << key << ".bin";
+    const auto libraryPath = std::filesystem::path(MOVEMANAGER_MOVE_LIBRARY_DIR) / libraryName.str();
+    if (LoadMoveLibrary(libraryPath.string(), key)) {
+        BuildOffsetIndex();
+        CompileStencil();
+        CompileMoveChecks();
+        return;
+    }
+#endif
     nlohmann::json moveJson;
     for (const auto& moveFile : std::filesystem::recursive_directory_iterator(movePath)) {
         std::ifstream(moveFile.path()) >> moveJson;
@@ -454,14 +727,121 @@ void MoveManager::RegisterAllMoves(const std::string& movePath) {
         }
         // might need to close the ifstream idk yet
     }
+#if MOVEMANAGER_MOVE_LIBRARY_CACHE
+    SaveMoveLibrary(libraryPath.string(), key);
+#endif
+    BuildOffsetIndex();
+    CompileStencil();
+    CompileMoveChecks();
+}
+
+void MoveManager::CompileStencil() {
+    _stencil.clear();
+    _offsetStencilIndices.clear();
+    const auto stencilIndex = [](const LatticeCoord& coords) {
+        const auto it = std::ranges::find(_stencil, coords);
+        if (it != _stencil.end()) return static_cast<int>(it - _stencil.begin());
+        _stencil.push_back(coords);
+        return static_cast<int>(_stencil.size()) - 1;
+    };
+    for (const auto& offset : _offsets) {
+        _offsetStencilIndices.push_back(stencilIndex(offset));
+    }
+    for (const auto move : _moves) {
+        move->stencilChecked = 0;
+        move->stencilOccupied = 0;
+        for (const auto& [offset, occupied] : move->moves) {
+            const int index = stencilIndex(offset);
+            if (index >= 64) break;
+            move->stencilChecked |= std::uint64_t{1} << index;
+            move->stencilOccupied |= static_cast<std::uint64_t>(occupied) << index;
+        }
+    }
+    if (_stencil.size() > 64) {
+        _stencil.clear();
+        _offsetStencilIndices.clear();
+    }
+}
+
+void MoveManager::CompileMoveChecks() {
+    for (const auto move : _moves) {
+        move->CompileIndexOffsets(Lattice::coordTensor);
+    }
+    _stencilIndexOffsets.clear();
+    if (Lattice::coordTensor.Storage() == TENSOR_DENSE && Lattice::coordTensor.Layout() == TENSOR_LINEAR) {
+        for (const auto& offset : _stencil) {
+            _stencilIndexOffsets.push_back(Lattice::coordTensor.IndexOffset(offset));
+        }
+    }
+    _indexAxisSizes = Lattice::AxisSizes();
+    InvalidateAllMoves();
+}
+
+bool MoveManager::IndexOffsetsApply(const CoordTensor<int>& tensor) {
+    return &tensor == &Lattice::coordTensor && tensor.AxisSizes() == _indexAxisSizes;
+}
+
+MoveBase* MoveManager::GetMove(const int id) {
+    return _moves[id];
+}
+
+float MoveManager::MinMoveCost() {
+    return _minMoveCost;
+}
+
+bool MoveManager::UniformMoveCosts() {
+    return _uniformMoveCosts;
+}
+
+int MoveManager::MoveReach() {
+    int reach = 0;
+    for (const auto move : _moves) {
+        for (const auto& [offset, check] : move->moves) {
+            for (int i = 0; i < Lattice::Order(); i++) {
+                reach = std::max(reach, std::abs(offset[i]));
+            }
+        }
+    }
+    return reach;
 }
 
 #define MOVEMANAGER_CHECK_BY_OFFSET true
 std::vector<MoveBase*> MoveManager::CheckAllMoves(CoordTensor<int> &tensor, Module &mod) {
     std::vector<MoveBase*> legalMoves = {};
 #if MOVEMANAGER_CHECK_BY_OFFSET
+#if !MOVEMANAGER_BOUNDS_CHECKS
+    if (!_stencil.empty() && IndexOffsetsApply(tensor)) {
+        // Read every stencil cell once, then check every move against the snapshot
+        std::uint64_t occupied = 0;
+        std::uint64_t blocked = 0;
+        const auto snapshot = [&](const int i, const int id) {
+            occupied |= static_cast<std::uint64_t>(id >= 0) << i;
+            blocked |= static_cast<std::uint64_t>(id >= 0 || id == OUT_OF_BOUNDS) << i;
+        };
+        if (!_stencilIndexOffsets.empty()) {
+            const int* cell = tensor.GetArrayInternal().data() + mod.index;
+            for (int i = 0; i < _stencilIndexOffsets.size(); i++) {
+                snapshot(i, cell[_stencilIndexOffsets[i]]);
+            }
+        } else {
+            for (int i = 0; i < _stencil.size(); i++) {
+                snapshot(i, std::as_const(tensor)[mod.coords + _stencil[i]]);
+            }
+        }
+        for (int i = 0; i < _offsets.size(); i++) {
+            if ((blocked >> _offsetStencilIndices[i]) & 1) continue;
+            for (const auto move : _movesByOffset[_offsets[i]]) {
+                if ((occupied & move->stencilChecked) == move->stencilOccupied) {
+                    legalMoves.push_back(move);
+                    break;
+                }
+            }
+        }
+        return legalMoves;
+    }
+#endif
     for (const auto& moveOffset : _offsets) {
-        if (const auto id = Lattice::coordTensor[mod.coords + moveOffset]; id == OUT_OF_BOUNDS || id >= 0) continue;
+        if (const auto id = std::as_const(Lattice::coordTensor)[mod.coords + moveOffset]; id == OUT_OF_BOUNDS || id >= 0) continue;
         for (auto move : _movesByOffset[moveOffset]) {
             if (move->MoveCheck(tensor, mod)) {
 #if MOVEMANAGER_VERBOSE == MM_LOG_MOVE_CHECKS
@@ -493,23 +873,29 @@ std::vector<MoveBase*> MoveManager::CheckAllMoves(CoordTensor<int> &tensor, Modu
     return legalMoves;
 }
 
-std::vector<std::vector<Module*>> GenerateFreeModulePowerSet() {
-    std::vector<std::vector<Module*>> mods(1 << ModuleIdManager::MinStaticID(), std::vector<Module*>());
-    for (int i = 0; i < 1 << ModuleIdManager::MinStaticID(); ++i) {
-        for (int j = 0; j < sizeof(int) * 8; j++) {
-            if (i & 1 << j) {
-                mods[i].push_back(&ModuleIdManager::GetModule(j));
-            }
+namespace {
+    // Advance a combination of indices into a list of n items to the next combination of the same size in
+    // lexicographic order, returns false once every combination has been visited
+    bool NextCombination(std::vector<int>& combination, const int n) {
+        const int k = static_cast<int>(combination.size());
+        int i = k - 1;
+        while (i >= 0 && combination[i] == n - k + i) {
+            i--;
+        }
+        if (i < 0) return false;
+        combination[i]++;
+        for (int j = i + 1; j < k; j++) {
+            combination[j] = combination[j - 1] + 1;
         }
+        return true;
     }
-    return mods;
 }
 
 bool ParallelMoveCheck(CoordTensor<int>& freeSpace, const Module& mod, const MoveBase* move) {
     if (freeSpace[mod.coords + move->MoveOffset()] == OUT_OF_BOUNDS) return false;
     //if (freeSpace[mod.coords + move->MoveOffset()] >= ModuleIdManager::MinStaticID()) return false;
-    bool result = std::all_of(std::execution::par_unseq, move->moves.begin(), move->moves.end(), [&move = std::as_const(move), &mod = std::as_const(mod), &freeSpace](auto& moveCheck) {
-        if (freeSpace[mod.coords + moveCheck.first] < 0) {
+    bool result = std::all_of(std::execution::seq, move->moves.begin(), move->moves.end(), [&move = std::as_const(move), &mod = std::as_const(mod), &freeSpace](auto& moveCheck) {
+        if (std::as_const(freeSpace)[mod.coords + moveCheck.first] < 0) {
             // Space is not occupied
             if (moveCheck.second) {
                 // But we wanted it to be! Invalid move.
@@ -520,7 +906,7 @@ bool ParallelMoveCheck(CoordTensor<int>& freeSpace, const Module& mod, const Mov
         } else if (!moveCheck.second) {
             // Space is occupied, but we don't want it to be! Invalid move.
             return false;
-        } else if (freeSpace[mod.coords + moveCheck.first] == OCCUPIED_NO_ANCHOR) {
+        } else if (std::as_const(freeSpace)[mod.coords + moveCheck.first] == OCCUPIED_NO_ANCHOR) {
             // Space is considered occupied, but not permitted for use as an anchor! Invalid move.
             return false;
         }
@@ -542,236 +928,195 @@ bool ParallelMoveCheck(CoordTensor<int>& freeSpace, const Module& mod, const Mov
 }
 
 std::vector<std::set<ModuleData>> MoveManager::MakeAllParallelMoves(std::unordered_set<HashedState>& visited) {
-    static std::vector<std::vector<Module*>> modsToMove = GenerateFreeModulePowerSet();
-    static CoordTensor<int> freeSpaceInternal(Lattice::Order(), Lattice::AxisSize(), FREE_SPACE);
-    // Needed for cut vertex checks
-    // std::set<Module*> movableModules = std::set(Lattice::MovableModules().begin(), Lattice::MovableModules().end());
-    // Might speed things up
-    static std::vector<std::unordered_set<MoveBase*>> failedMoves(ModuleIdManager::MinStaticID(), std::unordered_set<MoveBase*>());
-    for (auto fails : failedMoves) {
-        fails.clear();
-    }
-    for (const auto& mod : ModuleIdManager::FreeModules()) {
-        Lattice::coordTensor[mod.coords] = FREE_SPACE;
-    }
-    for (const auto& mod : ModuleIdManager::FreeModules()) {
-        for (auto move : _moves) {
-            if (!move->FreeSpaceCheck(Lattice::coordTensor, mod.coords)) {
-                failedMoves[mod.id].insert(move);
-            }
-        }
-    }
-    for (const auto& mod : ModuleIdManager::FreeModules()) {
-        Lattice::coordTensor[mod.coords] = mod.id;
-    }
+    static CoordTensor<int> freeSpaceInternal(Lattice::AxisSizes(), FREE_SPACE);
     std::vector<std::set<ModuleData>> adjStates;
-    // Iterate over all combinations of movable modules
-    for (const auto& mods : modsToMove) {
-        if (mods.empty()) continue;
-        // if (std::any_of(std::execution::par_unseq, mods.begin(), mods.end(), [&](auto mod) {
-        //     return !movableModules.contains(mod);
-        // })) {
-        //     continue;
-        // }
-        for (const auto& mod : mods) {
-            Lattice::ClearAdjacencies(mod->id);
-            Lattice::AddEdge(mod->id, ModuleIdManager::MinStaticID());
-        }
-        bool connected = Lattice::checkConnected();
-        for (const auto& mod : mods) {
-            Lattice::ClearAdjacencies(mod->id);
-#if LATTICE_RD_EDGECHECK
-            Lattice::RDEdgeCheck(*mod);
+    // Modules are tried in ID order, the same order they appear in module data
+#if MOVEMANAGER_PARALLEL_MOVABLE_ONLY
+    auto candidates = Lattice::MovableModules();
+    std::ranges::sort(candidates, {}, &Module::id);
 #else
-            Lattice::EdgeCheck(*mod);
+    std::vector<Module*> candidates;
+    for (auto& mod : ModuleIdManager::FreeModules()) {
+        candidates.push_back(&mod);
+    }
 #endif
-        }
-        if (!connected) continue;
-        //freeSpaceInternal.Fill(FREE_SPACE);
-        const int modCount = mods.size();
-        const int moveCount = _moves.size();
-        // const int movesToProcess = /*moveCount * modCount*/ std::pow(modCount, moveCount);
-        // int movesProcessed = 0;
-        const int movesToProcess = std::pow(moveCount, modCount);
-        int movesProcessed = 0;
-        bool skipUpdate = false;
-        // Starts at [0, ... , 0], should end at [moveCount - 1, ... , moveCount - 1]
-        // std::cout << "BEGIN PROCESSING" << std::endl;
-        std::vector<int> modMoveIndex(modCount, 0);
-        modMoveIndex.back() = -1;
-        while (!std::ranges::all_of(modMoveIndex, [&](int index) {
-            return index == moveCount - 1;
-        })) {
-            // std::cout << "Current Move Indices:  ";
-            // for (int i = 0; i < modCount; i++) {
-            //     std::cout << modMoveIndex[i] << " ";
-            // }
-            // std::cout << std::endl;
-            // Set indices to next batch of moves to check
-            for (int i = modCount - 1; i >= 0; i--) {
-                if (skipUpdate) break;
-                if (modMoveIndex[i] == moveCount - 1) {
-                    modMoveIndex[i] = 0;
-                } else {
-                    modMoveIndex[i]++;
-                    break;
-                }
+    const int candidateCount = static_cast<int>(candidates.size());
+    const int maxModsToMove = std::min(candidateCount, MOVEMANAGER_PARALLEL_MAX_MODULES);
+    std::vector<Module*> mods;
+    // Iterate over every combination of candidate modules, smallest first
+    for (int subsetSize = 1; subsetSize <= maxModsToMove; subsetSize++) {
+        std::vector<int> combination(subsetSize);
+        std::iota(combination.begin(), combination.end(), 0);
+        do {
+            mods.clear();
+            for (const int i : combination) {
+                mods.push_back(candidates[i]);
             }
-            movesProcessed++;
-            skipUpdate = false;
-            // another day another banger
-            int indexFailed = -1;
-            // for (int i = 0; i < modCount; i++) {
-            //     if (failedMoves[mods[i]->id].contains(_moves[modMoveIndex[i]])) {
-            //         indexFailed = i;
-            //         break;
-            //     }
-            // }
-            if (indexFailed == -1) {
+            if (!Lattice::checkConnected(mods)) continue;
+            const int modCount = mods.size();
+            const int moveCount = _moves.size();
+            bool skipUpdate = false;
+            // Starts at [0, ... , 0], should end at [moveCount - 1, ... , moveCount - 1]
+            std::vector<int> modMoveIndex(modCount, 0);
+            modMoveIndex.back() = -1;
+            while (!std::ranges::all_of(modMoveIndex, [&](int index) {
+                return index == moveCount - 1;
+            })) {
+                // Set indices to next batch of moves to check
+                for (int i = modCount - 1; i >= 0; i--) {
+                    if (skipUpdate) break;
+                    if (modMoveIndex[i] == moveCount - 1) {
+                        modMoveIndex[i] = 0;
+                    } else {
+                        modMoveIndex[i]++;
+                        break;
+                    }
+                }
+                skipUpdate = false;
+                int indexFailed = -1;
                 for (int i = 0; i < modCount; i++) {
                     if (!_moves[modMoveIndex[i]]->FreeSpaceCheck(Lattice::coordTensor, mods[i]->coords)) {
                         indexFailed = i;
                         break;
                     }
                 }
-            }
-            if (indexFailed != -1) {
-                skipUpdate = true;
-                if (modMoveIndex[indexFailed] == moveCount - 1) {
-                    if (indexFailed == 0) break;
-                    modMoveIndex[indexFailed] = 0;
-                    bool escape = false;
-                    for (int i = indexFailed; i >= 0; i--) {
-                        if (i == indexFailed) continue;
-                        //modMoveIndex[i] = 0;
-                        if (modMoveIndex[i] == moveCount - 1) {
-                            if (i == 0) {
-                                escape = true;
+                if (indexFailed != -1) {
+                    skipUpdate = true;
+                    if (modMoveIndex[indexFailed] == moveCount - 1) {
+                        if (indexFailed == 0) break;
+                        modMoveIndex[indexFailed] = 0;
+                        bool escape = false;
+                        for (int i = indexFailed; i >= 0; i--) {
+                            if (i == indexFailed) continue;
+                            if (modMoveIndex[i] == moveCount - 1) {
+                                if (i == 0) {
+                                    escape = true;
+                                    break;
+                                }
+                                modMoveIndex[i] = 0;
+                            } else {
+                                modMoveIndex[i]++;
                                 break;
                             }
-                            modMoveIndex[i] = 0;
-                        } else {
-                            modMoveIndex[i]++;
-                            break;
                         }
+                        if (escape) break;
+                    } else {
+                        modMoveIndex[indexFailed]++;
                     }
-                    if (escape) break;
-                } else {
-                    modMoveIndex[indexFailed]++;
-                }
-                for (int i = indexFailed + 1; i < modCount - 1; i++) {
-                    modMoveIndex[i] = 0;
+                    for (int i = indexFailed + 1; i < modCount - 1; i++) {
+                        modMoveIndex[i] = 0;
+                    }
+                    continue;
                 }
-                // std::cout << "Promoted Move Indices: ";
-                // for (int i = 0; i < modCount; i++) {
-                //     std::cout << modMoveIndex[i] << " ";
-                // }
-                // std::cout << std::endl;
-                continue;
-            }
-            // std::cout << "New Move Indices:      ";
-            // for (int i = 0; i < modCount; i++) {
-            //     std::cout << modMoveIndex[i] << " ";
-            // }
-            // std::cout << std::endl;
-            // Check to avoid duplicate state
-            for (int i = 0; i < modCount; i++) {
-                auto move = _moves[modMoveIndex[i]];
-                auto mod = mods[i];
-                mod->coords += move->MoveOffset();
-            }
-            bool duplicate = visited.contains(HashedState(Lattice::GetModuleInfo()));
-            for (int i = 0; i < modCount; i++) {
-                auto move = _moves[modMoveIndex[i]];
-                auto mod = mods[i];
-                mod->coords -= move->MoveOffset();
-            }
-            if (duplicate) continue;
-            // Set up local free space tensor to match lattice
-            freeSpaceInternal.FillFromVector(Lattice::coordTensor.GetArrayInternal());
-            //freeSpaceInternal = Lattice::coordTensor;
-            // Initial setup
-            bool success = true;
-            for (int i = 0; i < modCount; i++) {
-                // Forbid current position of all moving modules to be used as anchor
-                freeSpaceInternal[mods[i]->coords] = OCCUPIED_NO_ANCHOR;
-            }
-            // mod[i] checks move[i]
-            for (int i = 0; i < modCount; i++) {
-                auto move = _moves[modMoveIndex[i]];
-                auto mod = mods[i];
-                if (!ParallelMoveCheck(freeSpaceInternal, *mod, move)) {
-                    success = false;
-                    break;
+                // Check to avoid duplicate state
+                for (int i = 0; i < modCount; i++) {
+                    auto move = _moves[modMoveIndex[i]];
+                    auto mod = mods[i];
+                    mod->coords += move->MoveOffset();
                 }
-            }
-            if (success) {
+                bool duplicate = visited.contains(HashedState(Lattice::GetModuleInfo()));
                 for (int i = 0; i < modCount; i++) {
                     auto move = _moves[modMoveIndex[i]];
                     auto mod = mods[i];
-                    Lattice::MoveModule(*mod, move->MoveOffset());
+                    mod->coords -= move->MoveOffset();
+                }
+                if (duplicate) continue;
+                // Set up local free space tensor to match lattice
+                freeSpaceInternal = Lattice::coordTensor;
+                // Initial setup
+                bool success = true;
+                for (int i = 0; i < modCount; i++) {
+                    // Forbid current position of all moving modules to be used as anchor
+                    freeSpaceInternal[mods[i]->coords] = OCCUPIED_NO_ANCHOR;
                 }
-                adjStates.push_back(Lattice::GetModuleInfo());
-                visited.insert(HashedState(Lattice::GetModuleInfo()));
+                // mod[i] checks move[i]
                 for (int i = 0; i < modCount; i++) {
                     auto move = _moves[modMoveIndex[i]];
                     auto mod = mods[i];
-                    Lattice::MoveModule(*mod, -move->MoveOffset());
+                    if (!ParallelMoveCheck(freeSpaceInternal, *mod, move)) {
+                        success = false;
+                        break;
+                    }
+                }
+                if (success) {
+                    for (int i = 0; i < modCount; i++) {
+                        auto move = _moves[modMoveIndex[i]];
+                        auto mod = mods[i];
+                        Lattice::MoveModule(*mod, move->MoveOffset());
+                    }
+                    adjStates.push_back(Lattice::GetModuleInfo());
+                    visited.insert(HashedState(Lattice::GetModuleInfo()));
+                    for (int i = 0; i < modCount; i++) {
+                        auto move = _moves[modMoveIndex[i]];
+                        auto mod = mods[i];
+                        Lattice::MoveModule(*mod, -move->MoveOffset());
+                    }
                 }
             }
-        }
-        // std::cout << "Final Move Indices: ";
-        // for (int i = 0; i < modCount; i++) {
-        //     std::cout << modMoveIndex[i] << " ";
-        // }
-        // std::cout << std::endl;
+        } while (NextCombination(combination, candidateCount));
     }
     return adjStates;
 }
 
-#define MOVEMANAGER_CHECK_BY_OFFSET true
-std::vector<MoveBase*> MoveManager::CheckAllMovesAndConnectivity(CoordTensor<int> &tensor, Module &mod) {
-    std::vector<MoveBase*> legalMoves = {};
-#if MOVEMANAGER_CHECK_BY_OFFSET
-    for (const auto& moveOffset : _offsets) {
-        for (auto move : _movesByOffset[moveOffset]) {
-            if (move->MoveCheck(tensor, mod) && checkConnected(tensor, mod, move)) {
-#if MOVEMANAGER_VERBOSE == MM_LOG_MOVE_CHECKS
-                DEBUG("passed!\n");
-#endif
-                legalMoves.push_back(move);
-                break;
-#if MOVEMANAGER_VERBOSE == MM_LOG_MOVE_CHECKS
-            } else {
-                DEBUG("failed!\n");
-#endif
-            }
-        }
+const std::vector<MoveBase*>& MoveManager::CachedMoves(Module& mod) {
+    if (mod.id >= _legalMoves.size()) {
+        _legalMoves.resize(mod.id + 1);
+        _legalMovesValid.resize(mod.id + 1, false);
     }
-#else
-    for (auto move : _moves) {
-        if (move->MoveCheck(tensor, mod)) {
-#if MOVEMANAGER_VERBOSE == MM_LOG_MOVE_CHECKS
-            DEBUG("passed!\n");
-#endif
-            legalMoves.push_back(move);
-#if MOVEMANAGER_VERBOSE == MM_LOG_MOVE_CHECKS
-        } else {
-            DEBUG("failed!\n");
-#endif
+    if (!_legalMovesValid[mod.id]) {
+        _legalMoves[mod.id] = CheckAllMoves(Lattice::coordTensor, mod);
+        _legalMovesValid[mod.id] = true;
+    }
+    return _legalMoves[mod.id];
+}
+
+void MoveManager::InvalidateMovesNear(const LatticeCoord& cell) {
+    // Without a stencil there is no footprint to go by
+    if (_stencil.empty()) {
+        InvalidateAllMoves();
+        return;
+    }
+    const auto& axisSizes = Lattice::AxisSizes();
+    const auto invalidate = [&](const LatticeCoord& coords) {
+        for (int i = 0; i < Lattice::Order(); i++) {
+            if (coords[i] < 0 || coords[i] >= axisSizes[i]) return;
         }
+        const int id = std::as_const(Lattice::coordTensor)[coords];
+        if (id >= 0 && id < _legalMovesValid.size()) {
+            _legalMovesValid[id] = false;
+        }
+    };
+    // A module at p checks cells p + s for each stencil offset s, so a change at cell affects modules at cell - s
+    invalidate(cell);
+    for (const auto& offset : _stencil) {
+        invalidate(cell - offset);
     }
-#endif
+}
+
+void MoveManager::InvalidateAllMoves() {
+    std::fill(_legalMovesValid.begin(), _legalMovesValid.end(), false);
+}
+
+std::vector<MoveBase*> MoveManager::CheckAllMovesAndConnectivity(CoordTensor<int> &tensor, Module &mod) {
+    auto legalMoves = CheckAllMoves(tensor, mod);
+    std::erase_if(legalMoves, [&](const MoveBase* move) {
+        return !checkConnected(tensor, mod, move);
+    });
     return legalMoves;
 }
 
 bool MoveManager::checkConnected(const CoordTensor<int>& tensor, const Module& mod, const MoveBase* move) {
-    return false;
+    const auto destination = mod.coords + move->MoveOffset();
+    auto result = Lattice::CheckConnectedAfterMove(tensor, mod.coords, destination, true);
+    if (result == CONNECTIVITY_UNKNOWN) {
+        result = Lattice::CheckConnectedAfterMove(tensor, mod.coords, destination, false);
+    }
+    return result == CONNECTIVITY_KEPT;
 }
 
 std::pair<Module*, MoveBase*> MoveManager::FindMoveToState(const std::set<ModuleData>& modData) {
     Module* modToMove = nullptr;
-    std::valarray<int> destination;
+    LatticeCoord destination;
     std::unordered_set<int> candidates;
     for (int id = 0; id < ModuleIdManager::MinStaticID(); id++) {
         candidates.insert(id);
@@ -797,26 +1142,4 @@ std::pair<Module*, MoveBase*> MoveManager::FindMoveToState(const std::set<Module
         }
     }
     return {modToMove, nullptr};
-    // Find module to move
-    /*for (size_t i = 0; i < Lattice::stateTensor.GetArrayInternal().size(); i++) {
-        if (Lattice::stateTensor.GetElementDirect(i) != state.GetElementDirect(i) && !state.GetElementDirect(i)) {
-            modToMove = &ModuleIdManager::Modules()[Lattice::coordTensor.GetElementDirect(i)];
-            break;
-        }
-    }
-    if (modToMove == nullptr) {
-        return {nullptr, nullptr};
-    }
-    auto& modCoords = modToMove->coords;
-    for (auto& offset : _offsets) {
-        // Find offset to move to
-        if (!state[modCoords + offset]) continue;
-        // Find move to get there
-        for (auto move : _movesByOffset[offset]) {
-            if (move->MoveCheck(Lattice::coordTensor, *modToMove)) {
-                return {modToMove, move};
-            }
-        }
-    }
-    return {modToMove, nullptr};*/
 }
\ No newline at end of file
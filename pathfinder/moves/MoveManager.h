@@ -24,6 +24,30 @@
  * false: Padding around the coordinate tensor is assumed to prevent any out-of-bounds checks from occuring
  */
 #define MOVEMANAGER_BOUNDS_CHECKS false
+/* Legal Move Cache Configuration
+ * true: Legal moves found for each module are kept until the lattice changes within the module's move stencil, so
+ *       expanding a state only rechecks modules near the move that led to it
+ * false: Legal moves are checked for every movable module whenever a state is expanded
+ */
+#define MOVEMANAGER_CACHE_LEGAL_MOVES true
+/* Move Library Cache Configuration
+ * true: Moves generated from a move directory are written to a binary move library in MOVEMANAGER_MOVE_LIBRARY_DIR,
+ *       later runs with the same move files, lattice order and geometry map the library instead of parsing and
+ *       transforming every move definition again (requires POSIX mmap)
+ * false: Move definitions are always parsed and transformed at startup
+ * MOVEMANAGER_MOVE_LIBRARY_DIR: Directory move libraries are kept in, relative paths are relative to the working
+ *       directory like "Module Properties/"
+ */
+#define MOVEMANAGER_MOVE_LIBRARY_CACHE true
+#define MOVEMANAGER_MOVE_LIBRARY_DIR "Move Library/"
+/* Parallel Move Configuration
+ * MOVEMANAGER_PARALLEL_MAX_MODULES: Most modules that can move at once in a single parallel step
+ * MOVEMANAGER_PARALLEL_MOVABLE_ONLY:
+ *   true: Only modules that can move on their own without disconnecting the configuration are moved in parallel
+ *   false: Any combination of free modules may be moved in parallel, as long as what remains stays connected
+ */
+#define MOVEMANAGER_PARALLEL_MAX_MODULES 4
+#define MOVEMANAGER_PARALLEL_MOVABLE_ONLY true
 
 namespace Move {
     enum State {
@@ -120,11 +144,22 @@ namespace Move {
 class MoveBase : public ITransformable {
 protected:
     // each pair represents a coordinate offset to check and whether a module should be there or not
-    std::vector<std::pair<std::valarray<int>, bool>> moves;
+    std::vector<std::pair<LatticeCoord, bool>> moves;
     // bounds ex: {(2, 1), (0, 1)} would mean bounds extend from -2 to 1 on x-axis and 0 to 1 on y-axis
     std::vector<std::pair<int, int>> bounds;
-    std::valarray<int> initPos, finalPos;
+    LatticeCoord initPos, finalPos;
     std::vector<std::pair<Move::AnimType, std::valarray<int>>> animSequence;
+    // Change in tensor index for each cell to check, empty unless the tensor the move was compiled for is dense and uses
+    // linear layout
+    std::vector<int> indexOffsets;
+    // Move requirements as masks over the cells of MoveManager's stencil, the move is possible if the occupied stencil
+    // cells masked by stencilChecked equal stencilOccupied
+    std::uint64_t stencilChecked = 0;
+    std::uint64_t stencilOccupied = 0;
+    // Index of the move in MoveManager's move list, -1 until the move is registered
+    int id = -1;
+    // Cost of making the move, such as the time it takes, 1 unless the move definition gives a cost
+    float cost = 1;
 public:
     // Load in move info from a given file
     // virtual void InitMove(std::ifstream& moveFile) = 0;
@@ -132,7 +167,15 @@ public:
     // Check to see if move is possible for a given module
     virtual bool MoveCheck(const CoordTensor<int>& tensor, const Module& mod) = 0;
     // Check to see if free space requirements are satisfied at a given position
-    virtual bool FreeSpaceCheck(const CoordTensor<int>& tensor, const std::valarray<int>& coords);
+    virtual bool FreeSpaceCheck(const CoordTensor<int>& tensor, const LatticeCoord& coords);
+    // Free space check that also limits how much help from other non-static modules a move may rely on
+    virtual bool FreeSpaceCheckHelpLimit(const CoordTensor<int>& tensor, const LatticeCoord& coords, const CoordTensor<int>& helpTensor, int help);
+    // Compile move requirements into index offsets for a given tensor, nothing is compiled unless the tensor is dense and
+    // uses linear layout
+    void CompileIndexOffsets(const CoordTensor<int>& tensor);
+    // Check whether index offsets were compiled for this move
+    [[nodiscard]]
+    bool HasIndexOffsets() const;
 
     [[nodiscard]]
     MoveBase* MakeCopy() const override = 0;
@@ -142,7 +185,21 @@ public:
     void Reflect(int index) override;
 
     [[nodiscard]]
-    const std::valarray<int>& MoveOffset() const;
+    const LatticeCoord& MoveOffset() const;
+
+    [[nodiscard]]
+    int Id() const;
+
+    [[nodiscard]]
+    float Cost() const;
+
+    // Get the cells to check in sorted order, which is the same for any two definitions of the same move
+    [[nodiscard]]
+    std::vector<std::pair<LatticeCoord, bool>> SortedChecks() const;
+
+    // Hash of the sorted cells to check and the final position, equal moves always have the same hash
+    [[nodiscard]]
+    std::size_t CanonicalHash() const;
 
     [[nodiscard]]
     const std::vector<std::pair<Move::AnimType, std::valarray<int>>>& AnimSequence() const;
@@ -183,7 +240,42 @@ private:
     // Vector containing only generated moves
     static std::vector<MoveBase*> _movesToFree;
     // Vector containing all move offsets
-    static std::vector<std::valarray<int>> _offsets;
+    static std::vector<LatticeCoord> _offsets;
+    // Axis sizes of the lattice that move and stencil index offsets were compiled for
+    static std::vector<int> _indexAxisSizes;
+    // Every cell checked by any move, including move destinations, relative to the moving module. Empty if there are
+    // too many cells to represent a move as a mask over them.
+    static std::vector<LatticeCoord> _stencil;
+    // Change in lattice index for each stencil cell, empty unless the lattice is dense and uses linear layout
+    static std::vector<int> _stencilIndexOffsets;
+    // Index of the stencil cell at the destination of each move offset, in the same order as _offsets
+    static std::vector<int> _offsetStencilIndices;
+    // Legal moves of each free module on the lattice, indexed by module ID, and whether each entry is still valid
+    static std::vector<std::vector<MoveBase*>> _legalMoves;
+    static std::vector<bool> _legalMovesValid;
+    // Lowest cost of any move, and whether every move has that cost
+    static float _minMoveCost;
+    static bool _uniformMoveCosts;
+    // Registered moves by canonical hash, used to find duplicates without comparing against every move
+    static std::unordered_map<std::size_t, std::vector<MoveBase*>> _movesByHash;
+
+    // Register a move unless an equal move was already registered, returns whether the move was registered
+    static bool AddUniqueMove(MoveBase* move);
+
+#if MOVEMANAGER_MOVE_LIBRARY_CACHE
+    // Get a key identifying the moves generated from a move directory for the current lattice order and geometry
+    static std::uint64_t MoveLibraryKey(const std::string& movePath);
+
+    // Register every move in a move library, returns false without registering anything if the library is missing, was
+    // written by a different version or has a different key
+    static bool LoadMoveLibrary(const std::string& libraryPath, std::uint64_t key);
+
+    // Write every registered move to a move library
+    static void SaveMoveLibrary(const std::string& libraryPath, std::uint64_t key);
+#endif
+
+    // Build the stencil and each move's masks over it
+    static void CompileStencil();
 public:
     // Never instantiate MoveManager
     MoveManager() = delete;
@@ -200,13 +292,50 @@ public:
 
     static void RegisterAllMoves(const std::string& movePath = "Moves/");
 
+    // Rebuild the map from offset to move from every registered move, cheaper moves are listed first for each offset.
+    // RegisterAllMoves does this after loading every move file
+    static void BuildOffsetIndex();
+
+    // Compile index offsets for free space and stencil move checks, needed again whenever the lattice is recreated
+    static void CompileMoveChecks();
+
+    // Check whether compiled index offsets can be used with a tensor, which is only true for the lattice they were
+    // compiled for
+    static bool IndexOffsetsApply(const CoordTensor<int>& tensor);
+
+    // Get the largest distance along any axis between a module and a cell checked by one of its moves
+    static int MoveReach();
+
+    // Get a registered move by ID
+    static MoveBase* GetMove(int id);
+
+    // Get the lowest cost of any move, heuristics counting moves are scaled by this to stay admissible
+    static float MinMoveCost();
+
+    // Check whether every move has the same cost, in which case searches don't need to track path costs per state
+    static bool UniformMoveCosts();
+
     // Get what moves can be made by a module
     static std::vector<MoveBase*> CheckAllMoves(CoordTensor<int>& tensor, Module& mod);
 
+    // Get what moves can be made by a module on the lattice, reusing the result of an earlier check unless it has been
+    // invalidated since then
+    static const std::vector<MoveBase*>& CachedMoves(Module& mod);
+
+    // Invalidate cached moves of every module whose move stencil covers a cell
+    static void InvalidateMovesNear(const LatticeCoord& cell);
+
+    // Invalidate every cached move, needed whenever the lattice changes in a way that isn't tracked cell by cell
+    static void InvalidateAllMoves();
+
     static std::vector<std::set<ModuleData>> MakeAllParallelMoves(std::unordered_set<HashedState>& visited);
 
+    // Get what moves can be made by a module without disconnecting the configuration, unlike CheckAllMoves this works
+    // for any module, not just those that are movable
     static std::vector<MoveBase*> CheckAllMovesAndConnectivity(CoordTensor<int>& tensor, Module& mod);
 
+    // Check whether the configuration stays connected after a module makes a move, searching near the module first and
+    // only searching the whole configuration if that is inconclusive
     static bool checkConnected(const CoordTensor<int>& tensor, const Module& mod, const MoveBase* move);
 
     // Get a pair containing which module has to make what move in order to reach an adjacent state
@@ -1,6 +1,8 @@
 #include "Scenario.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <ranges>
 #include <boost/format.hpp>
 #include "../modules/ModuleManager.h"
 #include "MoveManager.h"
@@ -30,19 +32,188 @@ std::string Scenario::TryGetScenDesc(const std::string &initialFile) {
     return "Scenario file generated by pathfinder.";
 }
 
+namespace {
+    constexpr std::uint32_t PLAN_MAGIC = 0x4C50524D;
+    constexpr std::uint32_t PLAN_VERSION = 1;
+
+    // Get the module and move that lead to a configuration from the lattice state before it, using the transition
+    // recorded by the search when there is one
+    std::pair<Module*, MoveBase*> StepMove(const Configuration* config) {
+        if (const auto& transition = config->GetTransition(); transition.moveId >= 0) {
+            // Modules are found by position since identical modules may have different IDs in the lattice
+            if (const auto id = Lattice::coordTensor[transition.from]; id >= 0) {
+                return {&ModuleIdManager::GetModule(id), MoveManager::GetMove(transition.moveId)};
+            }
+        }
+        return MoveManager::FindMoveToState(config->GetModData());
+    }
+
+    // Replay a path from its first configuration, getting the module and move of each step. Returns false if a step
+    // has no move leading to it, the lattice is left in the state the replay reached.
+    bool ReplaySteps(const std::vector<Configuration*>& path, std::vector<Transition>& steps) {
+        Lattice::UpdateFromModuleInfo(path[0]->GetModData());
+        for (size_t i = 1; i < path.size(); i++) {
+            auto [movingModule, move] = StepMove(path[i]);
+            if (move == nullptr) {
+                return false;
+            }
+            const auto from = movingModule->coords;
+            steps.push_back({movingModule->id, from, from + move->MoveOffset(), move->Id()});
+            Lattice::MoveModule(*movingModule, move->MoveOffset());
+        }
+        return true;
+    }
+
+    // Apply or revert a block of steps, modules are found by position so the steps must not overlap
+    void MoveBlock(const std::vector<Transition>& block, const bool revert = false) {
+        std::vector<Module*> modules;
+        for (const auto& step : block) {
+            modules.push_back(&ModuleIdManager::GetModule(Lattice::coordTensor[revert ? step.to : step.from]));
+        }
+        for (int i = 0; i < block.size(); i++) {
+            Lattice::MoveModule(*modules[i], revert ? block[i].from - block[i].to : block[i].to - block[i].from);
+        }
+    }
+
+    // Check that the modules of a block can all leave at once and that the lattice is still connected after the
+    // block is made
+    bool BlockKeepsConnected(const std::vector<Transition>& block) {
+        std::vector<Module*> detached;
+        for (const auto& step : block) {
+            detached.push_back(&ModuleIdManager::GetModule(Lattice::coordTensor[step.from]));
+        }
+        if (!Lattice::checkConnected(detached)) {
+            return false;
+        }
+        MoveBlock(block);
+        const bool connected = Lattice::checkConnected();
+        MoveBlock(block, true);
+        return connected;
+    }
+
+    // Only merge runs of consecutive independent steps, every block then ends in a state the sequential path passes
+    // through so scheduling can't get stuck
+    std::vector<std::vector<Transition>> PackConsecutive(const std::vector<Transition>& steps,
+                                                         const std::vector<std::vector<int>>& preds) {
+        std::vector<std::vector<Transition>> blocks;
+        int blockStart = 0;
+        for (int i = 0; i < steps.size(); i++) {
+            if (!blocks.empty()) {
+                auto& block = blocks.back();
+                const bool independent = std::ranges::none_of(preds[i], [blockStart](const int p) {
+                    return p >= blockStart;
+                });
+                block.push_back(steps[i]);
+                if (independent && BlockKeepsConnected(block)) continue;
+                block.pop_back();
+                MoveBlock(block);
+            }
+            blocks.push_back({steps[i]});
+            blockStart = i;
+        }
+        if (!blocks.empty()) {
+            MoveBlock(blocks.back());
+        }
+        return blocks;
+    }
+}
+
+std::vector<std::vector<Transition>> Scenario::CompressPath(const std::vector<Configuration*>& path) {
+    std::vector<Transition> steps;
+    if (path.empty() || !ReplaySteps(path, steps)) {
+        return {};
+    }
+    const int stepCount = static_cast<int>(steps.size());
+    // Cells each step reads, its own cell and every cell its move checks
+    std::vector<std::vector<LatticeCoord>> footprints(stepCount);
+    for (int i = 0; i < stepCount; i++) {
+        footprints[i].push_back(steps[i].from);
+        for (const auto& offset : MoveManager::GetMove(steps[i].moveId)->SortedChecks() | std::views::keys) {
+            footprints[i].push_back(steps[i].from + offset);
+        }
+    }
+    // A step depends on an earlier step if either changes a cell the other reads, this also orders the steps of a
+    // single module
+    const auto writesInto = [&steps, &footprints](const int writer, const int reader) {
+        return std::ranges::any_of(footprints[reader], [&step = steps[writer]](const LatticeCoord& cell) {
+            return cell == step.from || cell == step.to;
+        });
+    };
+    std::vector<std::vector<int>> preds(stepCount);
+    for (int j = 0; j < stepCount; j++) {
+        for (int i = 0; i < j; i++) {
+            if (writesInto(i, j) || writesInto(j, i)) {
+                preds[j].push_back(i);
+            }
+        }
+    }
+    // List schedule the dependency graph, placing each step in the earliest block its dependencies allow and pushing it
+    // back when the block would disconnect the lattice
+    Lattice::UpdateFromModuleInfo(path[0]->GetModData());
+    std::vector<std::vector<Transition>> blocks;
+    std::vector<int> level(stepCount, 0);
+    std::vector<bool> scheduled(stepCount, false);
+    for (int remaining = stepCount, current = 0; remaining > 0; current++) {
+        for (int j = 0; j < stepCount; j++) {
+            for (const int p : preds[j]) {
+                level[j] = std::max(level[j], level[p] + 1);
+            }
+        }
+        std::vector<int> members;
+        auto& block = blocks.emplace_back();
+        for (int j = 0; j < stepCount; j++) {
+            if (scheduled[j] || level[j] != current) continue;
+            block.push_back(steps[j]);
+            if (BlockKeepsConnected(block)) {
+                members.push_back(j);
+            } else {
+                block.pop_back();
+                level[j]++;
+            }
+        }
+        if (block.empty()) {
+            // Every step that could be made here would disconnect the lattice
+            std::cout << "Path compression got stuck, only merging consecutive steps.\n";
+            Lattice::UpdateFromModuleInfo(path[0]->GetModData());
+            return PackConsecutive(steps, preds);
+        }
+        MoveBlock(block);
+        for (const int j : members) {
+            scheduled[j] = true;
+        }
+        remaining -= static_cast<int>(members.size());
+    }
+    return blocks;
+}
 
 void Scenario::exportToScen(const std::vector<Configuration *> &path, const ScenInfo &scenInfo) {
     if (path.empty()) {
         std::cerr << "Tried to export empty path, no good!" << std::endl;
         return;
     }
+    Lattice::UpdateFromModuleInfo(path[0]->GetModData());
+    std::vector<std::vector<Transition>> blocks;
+    if (scenInfo.parallelBlocks) {
+        blocks = CompressPath(path);
+    } else if (std::vector<Transition> steps; ReplaySteps(path, steps)) {
+        for (const auto& step : steps) {
+            blocks.push_back({step});
+        }
+    }
+    if (blocks.empty() && path.size() > 1) {
+        std::cout << "Failed to generate scenario file, no move to next state found.\n";
+        return;
+    }
+    if (scenInfo.parallelBlocks) {
+        std::cout << "Compressed " << path.size() - 1 << " moves into " << blocks.size() << " parallel steps.\n";
+    }
+    // Step back to the first configuration, updating from it again could give identical modules different IDs
+    for (const auto& block : blocks | std::views::reverse) {
+        MoveBlock(block, true);
+    }
     std::ofstream file(scenInfo.exportFile);
     file << scenInfo.scenName << std::endl << scenInfo.scenDesc << std::endl;
-#if LATTICE_RD_EDGECHECK
-    file << "RHOMBIC_DODECAHEDRON\n\n";
-#else
-    file << "CUBE\n\n";
-#endif
+    file << GeometryName(Lattice::geometry) << "\n\n";
     if (Lattice::ignoreProperties) {
         file << "0, 244, 244, 0, 95\n";
         file << "1, 255, 255, 255, 85\n\n";
@@ -56,34 +227,41 @@ void Scenario::exportToScen(const std::vector<Configuration *> &path, const Scen
     auto idLen = std::to_string(ModuleIdManager::Modules().size()).size();
     boost::format padding("%%0%dd, %s");
     boost::format modDef((padding % idLen % "%d, %d, %d, %d").str());
-    Lattice::UpdateFromModuleInfo(path[0]->GetModData());
     for (size_t id = 0; id < ModuleIdManager::Modules().size(); id++) {
         auto &mod = ModuleIdManager::Modules()[id];
+        const auto coords = mod.coords + Lattice::cropOrigin;
         if (Lattice::ignoreProperties) {
-            modDef % id % (mod.moduleStatic ? 1 : 0) % mod.coords[0] % mod.coords[1] % (mod.coords.size() > 2
-                    ? mod.coords[2]
-                    : 0);
+            modDef % id % (mod.moduleStatic ? 1 : 0) % coords[0] % coords[1] % coords[2];
         } else {
-            modDef % id % (mod.properties.Find(COLOR_PROP_NAME))->CallFunction<int>("GetColorInt") % mod.
-                    coords[0] % mod.coords[1] % (mod.coords.size() > 2 ? mod.coords[2] : 0);
+            modDef % id % (mod.properties.Find(COLOR_PROP_NAME))->CallFunction<int>("GetColorInt") % coords[0] %
+                    coords[1] % coords[2];
         }
         file << modDef.str() << std::endl;
     }
     file << std::endl;
-    for (size_t i = 1; i < path.size(); i++) {
-        auto [movingModule, move] = MoveManager::FindMoveToState(path[i]->GetModData());
-        if (move == nullptr) {
-            std::cout << "Failed to generate scenario file, no move to next state found.\n";
-            file.close();
-            return;
-        }
-        auto modToMove = movingModule;
-        for (const auto &[type, offset]: move->AnimSequence()) {
-            modDef % modToMove->id % type % offset[0] % offset[1] % offset[2];
-            file << modDef.str() << std::endl;
+    std::vector<std::int32_t> planWords = {
+        static_cast<std::int32_t>(PLAN_MAGIC),
+        static_cast<std::int32_t>(PLAN_VERSION),
+        static_cast<std::int32_t>(path.size() - 1)
+    };
+    // Each block is written as one checkpoint, the moves in it are made at the same time
+    for (const auto& block : blocks) {
+        for (const auto& step : block) {
+            const auto id = Lattice::coordTensor[step.from];
+            for (const auto &[type, offset]: MoveManager::GetMove(step.moveId)->AnimSequence()) {
+                modDef % id % type % offset[0] % offset[1] % offset[2];
+                file << modDef.str() << std::endl;
+            }
+            const auto offset = step.to - step.from;
+            planWords.insert(planWords.end(), {id, step.moveId, offset[0], offset[1], offset[2]});
         }
         file << std::endl;
-        Lattice::MoveModule(*modToMove, move->MoveOffset());
+        MoveBlock(block);
     }
     file.close();
+    if (!scenInfo.planFile.empty()) {
+        std::ofstream planFile(scenInfo.planFile, std::ios::binary);
+        planFile.write(reinterpret_cast<const char*>(planWords.data()),
+                       static_cast<std::streamsize>(planWords.size() * sizeof(std::int32_t)));
+    }
 }
@@ -11,12 +11,24 @@ namespace Scenario {
         std::string exportFile;
         std::string scenName;
         std::string scenDesc;
+        // Write moves that can be made at the same time as a single checkpoint, see CompressPath
+        bool parallelBlocks = false;
+        // Also export the path as a binary plan of 32-bit words when set: the magic number, the format version and the
+        // number of steps, followed by the module ID, move ID and x, y, z move offset of each step. The plan is written
+        // from the same steps as the scenario file so module IDs match, move IDs index MoveManager's move list.
+        std::string planFile;
     };
 
     std::string TryGetScenName(const std::string& initialFile);
 
     std::string TryGetScenDesc(const std::string& initialFile);
 
+    // Group the moves of a path into blocks that can be made at the same time. Moves depend on earlier moves that change
+    // a cell they check (or the other way around), the dependency graph is list scheduled into the earliest blocks that
+    // keep the lattice connected both while the moving modules are detached and after they land. Returns an empty list
+    // if the path can't be replayed, otherwise the lattice is left in the last configuration of the path.
+    std::vector<std::vector<Transition>> CompressPath(const std::vector<Configuration*>& path);
+
     void exportToScen(const std::vector<Configuration*>& path, const ScenInfo& scenInfo);
 }
 
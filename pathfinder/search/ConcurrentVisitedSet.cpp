@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <thread>
+#include <boost/functional/hash.hpp>
+#include "ConcurrentVisitedSet.h"
+
+namespace {
+    // splitmix64 finalizer, spreads fingerprint bits over slot indices
+    std::uint64_t Mix(std::uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+}
+
+std::uint64_t StateFingerprint(const std::set<ModuleData>& modData) {
+    const std::uint64_t fingerprint = Mix(boost::hash_range(modData.begin(), modData.end()));
+    // Keep clear of the reserved slot values
+    return fingerprint % ConcurrentVisitedSet::MAX_KEY + 1;
+}
+
+ConcurrentVisitedSet::Table::Table(const std::size_t capacity) : capacity(capacity),
+        slots(std::make_unique<std::atomic<std::uint64_t>[]>(capacity)) {}
+
+ConcurrentVisitedSet::ConcurrentVisitedSet(const std::size_t initialCapacity) {
+    std::size_t capacity = 1;
+    while (capacity < std::max<std::size_t>(initialCapacity, CONCURRENT_VISITED_MIGRATION_CHUNK)) {
+        capacity <<= 1;
+    }
+    tables.push_back(std::make_unique<Table>(capacity));
+    current.store(tables.back().get());
+}
+
+std::size_t ConcurrentVisitedSet::SlotIndex(const std::uint64_t key, const std::size_t capacity) {
+    return Mix(key) & (capacity - 1);
+}
+
+bool ConcurrentVisitedSet::Insert(const std::uint64_t key) {
+    if (InsertInto(current.load(std::memory_order_acquire), key)) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool ConcurrentVisitedSet::InsertInto(Table* table, const std::uint64_t key) {
+    while (true) {
+        Table* next = table->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            HelpMigrate(table);
+        }
+        const std::size_t mask = table->capacity - 1;
+        std::size_t index = SlotIndex(key, table->capacity);
+        for (std::size_t probes = 0; probes < table->capacity; probes++, index = (index + 1) & mask) {
+            auto& slot = table->slots[index];
+            std::uint64_t value = slot.load(std::memory_order_acquire);
+            while (value == EMPTY) {
+                if (next == nullptr) {
+                    // No resize in progress, claim the slot for this key
+                    if (slot.compare_exchange_strong(value, key, std::memory_order_acq_rel)) {
+                        if (table->used.fetch_add(1, std::memory_order_relaxed) + 1 > table->capacity / 2) {
+                            BeginResize(table);
+                        }
+                        return true;
+                    }
+                } else if (slot.compare_exchange_strong(value, SEALED, std::memory_order_acq_rel)) {
+                    // Resize in progress, seal the end of the probe sequence so the key can't appear here later
+                    value = SEALED;
+                }
+            }
+            if (value == key) {
+                return false;
+            }
+            if (value == SEALED || value == MIGRATED) {
+                if (next == nullptr) {
+                    next = table->next.load(std::memory_order_acquire);
+                }
+                if (value == SEALED) {
+                    break;
+                }
+            }
+        }
+        if (next == nullptr) {
+            // Table is full, wait for a larger one to be published
+            BeginResize(table);
+            std::this_thread::yield();
+            continue;
+        }
+        table = next;
+    }
+}
+
+void ConcurrentVisitedSet::BeginResize(Table* table) {
+    if (table->resizeClaimed.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    auto next = std::make_unique<Table>(table->capacity * 2);
+    table->next.store(next.get(), std::memory_order_release);
+    std::lock_guard lock(tablesMutex);
+    tables.push_back(std::move(next));
+}
+
+void ConcurrentVisitedSet::HelpMigrate(Table* table) {
+    const std::size_t start = table->migrateCursor.fetch_add(CONCURRENT_VISITED_MIGRATION_CHUNK,
+                                                             std::memory_order_relaxed);
+    if (start >= table->capacity) {
+        return;
+    }
+    Table* next = table->next.load(std::memory_order_acquire);
+    const std::size_t end = std::min(start + CONCURRENT_VISITED_MIGRATION_CHUNK, table->capacity);
+    for (std::size_t i = start; i < end; i++) {
+        auto& slot = table->slots[i];
+        std::uint64_t value = slot.load(std::memory_order_acquire);
+        // Slots only move forward from EMPTY, and only this thread migrates this slot
+        while (value == EMPTY && !slot.compare_exchange_strong(value, SEALED, std::memory_order_acq_rel)) {}
+        if (value != EMPTY && value != SEALED && value != MIGRATED) {
+            // Copy before marking so the key is always visible in at least one table
+            InsertInto(next, value);
+            slot.store(MIGRATED, std::memory_order_release);
+        }
+    }
+    if (table->migrated.fetch_add(end - start, std::memory_order_acq_rel) + (end - start) == table->capacity) {
+        AdvanceCurrent();
+    }
+}
+
+void ConcurrentVisitedSet::AdvanceCurrent() {
+    // Tables may finish migrating out of order, so skip every leading table that has fully moved
+    Table* table = current.load(std::memory_order_acquire);
+    while (table->migrated.load(std::memory_order_acquire) == table->capacity) {
+        Table* next = table->next.load(std::memory_order_acquire);
+        if (current.compare_exchange_strong(table, next, std::memory_order_acq_rel)) {
+            table = next;
+        }
+    }
+}
+
+bool ConcurrentVisitedSet::Contains(const std::uint64_t key) const {
+    const Table* table = current.load(std::memory_order_acquire);
+    while (table != nullptr) {
+        const std::size_t mask = table->capacity - 1;
+        std::size_t index = SlotIndex(key, table->capacity);
+        bool passedMigrated = false;
+        for (std::size_t probes = 0; probes < table->capacity; probes++, index = (index + 1) & mask) {
+            const std::uint64_t value = table->slots[index].load(std::memory_order_acquire);
+            if (value == key) {
+                return true;
+            }
+            if (value == EMPTY) {
+                // The key may have been migrated from a slot already passed
+                if (!passedMigrated) {
+                    return false;
+                }
+                break;
+            }
+            if (value == SEALED) {
+                break;
+            }
+            passedMigrated |= value == MIGRATED;
+        }
+        table = table->next.load(std::memory_order_acquire);
+    }
+    return false;
+}
+
+std::size_t ConcurrentVisitedSet::Size() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+std::size_t ConcurrentVisitedSet::Capacity() const {
+    const Table* table = current.load(std::memory_order_acquire);
+    while (const Table* next = table->next.load(std::memory_order_acquire)) {
+        table = next;
+    }
+    return table->capacity;
+}
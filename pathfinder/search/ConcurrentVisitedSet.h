@@ -0,0 +1,93 @@
+#ifndef MODULAR_ROBOTICS_CONCURRENTVISITEDSET_H
+#define MODULAR_ROBOTICS_CONCURRENTVISITEDSET_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "../modules/ModuleManager.h"
+
+/* Concurrent Visited Set Configuration
+ * INITIAL_CAPACITY: Number of slots in the first table, must be a power of 2
+ * MIGRATION_CHUNK: Number of slots an inserting thread migrates while a resize is in progress
+ * Tables grow to twice their size once they are half full
+ */
+#define CONCURRENT_VISITED_INITIAL_CAPACITY 1024
+#define CONCURRENT_VISITED_MIGRATION_CHUNK 64
+
+// Packed 64-bit fingerprint of a state, always a valid ConcurrentVisitedSet key
+std::uint64_t StateFingerprint(const std::set<ModuleData>& modData);
+
+// Lock-free open-addressing hash set of 64-bit state fingerprints. Insertion and lookup are a single linear probe
+// sequence using CAS on each slot. Once a table is half full a table of twice the size is published, and every
+// inserting thread migrates a chunk of the old table before inserting so the cost of growing is spread out.
+// Retired tables are kept until the set is destroyed since other threads may still be probing them.
+class ConcurrentVisitedSet {
+public:
+    // Slot values that can never be keys
+    static constexpr std::uint64_t EMPTY = 0;
+    static constexpr std::uint64_t MIGRATED = std::numeric_limits<std::uint64_t>::max() - 1;
+    static constexpr std::uint64_t SEALED = std::numeric_limits<std::uint64_t>::max();
+    static constexpr std::uint64_t MAX_KEY = MIGRATED - 1;
+private:
+    struct Table {
+        const std::size_t capacity;
+        const std::unique_ptr<std::atomic<std::uint64_t>[]> slots;
+        // # of slots holding a key, including keys copied in by migration
+        std::atomic<std::size_t> used = 0;
+        // Next table, non-null once a resize has begun
+        std::atomic<Table*> next = nullptr;
+        // Set by the thread allocating the next table
+        std::atomic<bool> resizeClaimed = false;
+        // Next slot to be claimed for migration
+        std::atomic<std::size_t> migrateCursor = 0;
+        // # of slots that have finished migrating
+        std::atomic<std::size_t> migrated = 0;
+
+        explicit Table(std::size_t capacity);
+    };
+
+    std::atomic<Table*> current;
+    std::atomic<std::size_t> count = 0;
+    // Every table ever allocated, freed on destruction
+    std::vector<std::unique_ptr<Table>> tables;
+    std::mutex tablesMutex;
+
+    // Insert into a table or one of its successors, returns false if key was already present
+    bool InsertInto(Table* table, std::uint64_t key);
+
+    // Publish a larger table if no other thread has done so
+    void BeginResize(Table* table);
+
+    // Migrate one chunk of a table to its successor
+    void HelpMigrate(Table* table);
+
+    // Move current past every table that has finished migrating
+    void AdvanceCurrent();
+
+    static std::size_t SlotIndex(std::uint64_t key, std::size_t capacity);
+public:
+    explicit ConcurrentVisitedSet(std::size_t initialCapacity = CONCURRENT_VISITED_INITIAL_CAPACITY);
+
+    ConcurrentVisitedSet(const ConcurrentVisitedSet&) = delete;
+
+    ConcurrentVisitedSet& operator=(const ConcurrentVisitedSet&) = delete;
+
+    // Insert a key in [1, MAX_KEY], returns false if it was already present
+    bool Insert(std::uint64_t key);
+
+    [[nodiscard]]
+    bool Contains(std::uint64_t key) const;
+
+    [[nodiscard]]
+    std::size_t Size() const;
+
+    // Number of slots in the newest table
+    [[nodiscard]]
+    std::size_t Capacity() const;
+};
+
+#endif //MODULAR_ROBOTICS_CONCURRENTVISITEDSET_H
@@ -9,6 +9,7 @@
 #include "ConfigurationSpace.h"
 #include "HeuristicCache.h"
 #include "SearchAnalysis.h"
+#include "StateRanking.h"
 
 const char * BFSExcept::what() const noexcept {
     return "BFS exhausted without finding a path!";
@@ -50,12 +51,22 @@ Configuration::~Configuration() {
 }
 
 std::vector<std::set<ModuleData>> Configuration::MakeAllMoves() const {
+    std::vector<Transition> transitions;
+    return MakeAllMoves(transitions);
+}
+
+std::vector<std::set<ModuleData>> Configuration::MakeAllMoves(std::vector<Transition>& transitions) const {
     std::vector<std::set<ModuleData>> result;
-    Lattice::UpdateFromModuleInfo(GetModData());
+    ConfigurationSpace::SyncLattice(this);
     std::vector<Module*> movableModules = Lattice::MovableModules();
     for (const auto module: movableModules) {
+#if MOVEMANAGER_CACHE_LEGAL_MOVES
+        const auto& legalMoves = MoveManager::CachedMoves(*module);
+#else
         auto legalMoves = MoveManager::CheckAllMoves(Lattice::coordTensor, *module);
+#endif
         for (const auto move : legalMoves) {
+            transitions.push_back({module->id, module->coords, module->coords + move->MoveOffset(), move->Id()});
             Lattice::MoveModule(*module, move->MoveOffset());
             result.emplace_back(Lattice::GetModuleInfo());
             Lattice::MoveModule(*module, -move->MoveOffset());
@@ -66,7 +77,7 @@ std::vector<std::set<ModuleData>> Configuration::MakeAllMoves() const {
 
 std::vector<std::set<ModuleData>> Configuration::MakeAllMovesForAllVertices() const {
     std::vector<std::set<ModuleData>> result;
-    Lattice::UpdateFromModuleInfo(GetModData());
+    ConfigurationSpace::SyncLattice(this);
     std::vector<Module*> movableModules;
     for (int id = 0; id < ModuleIdManager::MinStaticID(); id++) {
         movableModules.push_back(&ModuleIdManager::GetModule(id));
@@ -75,7 +86,7 @@ std::vector<std::set<ModuleData>> Configuration::MakeAllMovesForAllVertices() co
         auto legalMoves = MoveManager::CheckAllMoves(Lattice::coordTensor, *module);
         for (const auto move: legalMoves) {
             Lattice::MoveModule(*module, move->MoveOffset());
-            if (Lattice::checkConnected) {
+            if (Lattice::checkConnected()) {
                 result.emplace_back(Lattice::GetModuleInfo());
             }
             Lattice::MoveModule(*module, -move->MoveOffset());
@@ -84,11 +95,16 @@ std::vector<std::set<ModuleData>> Configuration::MakeAllMovesForAllVertices() co
     return result;
 }
 
-Configuration* Configuration::AddEdge(const std::set<ModuleData>& modData) {
+Configuration* Configuration::AddEdge(const std::set<ModuleData>& modData, const Transition& transition) {
     next.push_back(new Configuration(modData));
+    next.back()->transition = transition;
     return next.back();
 }
 
+const Transition& Configuration::GetTransition() const {
+    return transition;
+}
+
 Configuration* Configuration::GetParent() const {
     return parent;
 }
@@ -121,6 +137,65 @@ std::ostream& operator<<(std::ostream& out, const Configuration& config) {
 
 int ConfigurationSpace::depth = -1;
 
+namespace {
+    // Configuration the lattice was last synced to
+    const Configuration* latticeConfiguration = nullptr;
+}
+
+void ConfigurationSpace::SyncLattice(const Configuration* configuration) {
+    // Configurations without a parent may be temporaries, so they are never trusted to still be in the lattice
+    if (configuration == latticeConfiguration && configuration->GetParent() != nullptr) return;
+    // Walk both configurations up to their nearest common ancestor, collecting the moves to undo and redo
+    std::vector<const Configuration*> undo, redo;
+    const Configuration* from = latticeConfiguration;
+    const Configuration* to = configuration;
+    // Moving up from a configuration is only possible if the move that created it is known
+    const auto known = [](const Configuration* config) {
+        return config->GetParent() != nullptr && config->GetTransition().moduleId >= 0;
+    };
+    bool usable = from != nullptr;
+    while (usable && from != to) {
+        if (from->depth >= to->depth) {
+            usable = known(from);
+            undo.push_back(from);
+            from = from->GetParent();
+        } else {
+            usable = known(to);
+            redo.push_back(to);
+            to = to->GetParent();
+        }
+    }
+    if (usable) {
+        // Modules are found by position since a full update may have swapped identical modules around
+        for (const auto config : undo) {
+            const auto& transition = config->GetTransition();
+            Lattice::MoveModule(ModuleIdManager::GetModule(Lattice::coordTensor[transition.to]), transition.from - transition.to);
+        }
+        for (auto config = redo.rbegin(); config != redo.rend(); ++config) {
+            const auto& transition = (*config)->GetTransition();
+            Lattice::MoveModule(ModuleIdManager::GetModule(Lattice::coordTensor[transition.from]), transition.to - transition.from);
+        }
+        // Cached moves only need to be rechecked near cells that were changed
+        for (const auto config : undo) {
+            MoveManager::InvalidateMovesNear(config->GetTransition().from);
+            MoveManager::InvalidateMovesNear(config->GetTransition().to);
+        }
+        for (const auto config : redo) {
+            MoveManager::InvalidateMovesNear(config->GetTransition().from);
+            MoveManager::InvalidateMovesNear(config->GetTransition().to);
+        }
+    } else {
+        Lattice::UpdateFromModuleInfo(configuration->GetModData());
+        MoveManager::InvalidateAllMoves();
+    }
+    latticeConfiguration = configuration->GetParent() != nullptr ? configuration : nullptr;
+}
+
+void ConfigurationSpace::ResetLatticeSync() {
+    latticeConfiguration = nullptr;
+    MoveManager::InvalidateAllMoves();
+}
+
 std::vector<Configuration*> ConfigurationSpace::BFS(Configuration* start, const Configuration* final) {
 #if CONFIG_OUTPUT_JSON
     SearchAnalysis::EnterGraph("BFSDepthOverTime");
@@ -137,13 +212,40 @@ std::vector<Configuration*> ConfigurationSpace::BFS(Configuration* start, const
     int statesProcessed = 0;
     std::queue<Configuration*> q;
     std::unordered_set<HashedState> visited;
+#if CONFIG_DENSE_VISITED && !CONFIG_PARALLEL_MOVES
+    // Use perfect state ranking instead of hashing if the whole state space fits in a bitmap
+    const StateRanker ranker;
+    const bool useDenseVisited = ranker.Supported() && ranker.StateCount() / 8 <= CONFIG_DENSE_VISITED_MAX_BYTES;
+    DenseVisitedSet denseVisited(useDenseVisited ? ranker.StateCount() : 0);
+    if (useDenseVisited) {
+        std::cout << "BFS using dense visited set over " << ranker.StateCount() << " states." << std::endl;
+    }
+#endif
+    // Mark a state as visited, returns false if it was already visited
+    auto visit = [&](const std::set<ModuleData>& modData) {
+#if CONFIG_DENSE_VISITED && !CONFIG_PARALLEL_MOVES
+        if (useDenseVisited) {
+            return denseVisited.Insert(ranker.Rank(modData));
+        }
+#endif
+        return visited.insert(HashedState(modData)).second;
+    };
+    auto visitedCount = [&]() {
+#if CONFIG_DENSE_VISITED && !CONFIG_PARALLEL_MOVES
+        if (useDenseVisited) {
+            return denseVisited.Size();
+        }
+#endif
+        return visited.size();
+    };
     //start->SetStateAndHash(start->GetModData());
     //final->SetStateAndHash(final->GetModData());
+    ResetLatticeSync();
     q.push(start);
-    visited.insert(start->GetHash());
+    visit(start->GetModData());
     while (!q.empty()) {
         Configuration* current = q.front();
-        Lattice::UpdateFromModuleInfo(q.front()->GetModData());
+        SyncLattice(current);
 #if CONFIG_VERBOSE > CS_LOG_NONE
 #if CONFIG_OUTPUT_JSON
         SearchAnalysis::PauseClock();
@@ -153,14 +255,14 @@ std::vector<Configuration*> ConfigurationSpace::BFS(Configuration* start, const
 #if CONFIG_VERBOSE > CS_LOG_FINAL_DEPTH
             std::cout << "BFS Depth: " << q.front()->depth << std::endl
             << "Duplicate states Avoided: " << dupesAvoided << std::endl
-            << "States Discovered: " << visited.size() << std::endl
+            << "States Discovered: " << visitedCount() << std::endl
             << "States Processed: " << statesProcessed << std::endl
             << Lattice::ToString() << std::endl;
 #if CONFIG_OUTPUT_JSON
             SearchAnalysis::EnterGraph("BFSDepthOverTime");
             SearchAnalysis::InsertTimePoint(depth);
             SearchAnalysis::EnterGraph("BFSStatesOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
+            SearchAnalysis::InsertTimePoint(visitedCount());
 #endif
 #endif
         }
@@ -177,35 +279,37 @@ std::vector<Configuration*> ConfigurationSpace::BFS(Configuration* start, const
 #endif
             std::cout << "BFS Final Depth: " << q.front()->depth << std::endl
             << "Duplicate states Avoided: " << dupesAvoided << std::endl
-            << "States Discovered: " << visited.size() << std::endl
+            << "States Discovered: " << visitedCount() << std::endl
             << "States Processed: " << statesProcessed << std::endl
             << Lattice::ToString() << std::endl;
 #if CONFIG_OUTPUT_JSON
             SearchAnalysis::EnterGraph("BFSDepthOverTime");
             SearchAnalysis::InsertTimePoint(depth);
             SearchAnalysis::EnterGraph("BFSStatesOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
+            SearchAnalysis::InsertTimePoint(visitedCount());
 #endif
 #endif
             return FindPath(start, current);
         }
+        std::vector<Transition> transitions;
 #if !CONFIG_PARALLEL_MOVES
-        auto adjList = current->MakeAllMoves();
+        auto adjList = current->MakeAllMoves(transitions);
 #else
         auto adjList = MoveManager::MakeAllParallelMoves(visited);
+        transitions.resize(adjList.size());
 #endif
         statesProcessed++;
-        for (const auto& moduleInfo : adjList) {
+        for (int i = 0; i < adjList.size(); i++) {
+            const auto& moduleInfo = adjList[i];
 #if !CONFIG_PARALLEL_MOVES
-            if (visited.find(HashedState(moduleInfo)) == visited.end()) {
+            if (visit(moduleInfo)) {
 #endif
-                auto nextConfiguration = current->AddEdge(moduleInfo);
+                auto nextConfiguration = current->AddEdge(moduleInfo, transitions[i]);
                 nextConfiguration->SetParent(current);
                 //nextConfiguration->SetStateAndHash(moduleInfo);
                 q.push(nextConfiguration);
                 nextConfiguration->depth = current->depth + 1;
 #if !CONFIG_PARALLEL_MOVES
-                visited.insert(HashedState(moduleInfo));
             } else {
                 dupesAvoided++;
             }
@@ -215,23 +319,25 @@ std::vector<Configuration*> ConfigurationSpace::BFS(Configuration* start, const
     throw BFSExcept();
 }
 
-int Configuration::GetCost() const {
+float Configuration::GetCost() const {
     return cost;
 }
 
-void Configuration::SetCost(const int cost) {
+void Configuration::SetCost(const float cost) {
     this->cost = cost;
 }
 
 template <typename Heuristic>
 auto Configuration::CompareConfiguration(const Configuration* final, Heuristic heuristic) {
-    return [final, heuristic](Configuration* c1, Configuration* c2) {
+    // Heuristics count moves, every move costs at least the cheapest move's cost
+    const float moveCost = MoveManager::MinMoveCost();
+    return [final, heuristic, moveCost](Configuration* c1, Configuration* c2) {
 #if CONFIG_PARALLEL_MOVES
         const float cost1 = c1->GetCost() + (c1->*heuristic)(final) / ModuleIdManager::MinStaticID();
         const float cost2 = c2->GetCost() + (c2->*heuristic)(final) / ModuleIdManager::MinStaticID();
 #else
-        const float cost1 = c1->GetCost() + (c1->*heuristic)(final);
-        const float cost2 = c2->GetCost() + (c2->*heuristic)(final);
+        const float cost1 = c1->GetCost() + (c1->*heuristic)(final) * moveCost;
+        const float cost2 = c2->GetCost() + (c2->*heuristic)(final) * moveCost;
 #endif
         return (cost1 == cost2) ? c1->GetCost() > c2->GetCost() : cost1 > cost2;
     };
@@ -251,17 +357,20 @@ float Configuration::ManhattanDistance(const Configuration* final) const {
     auto currentIt = currentData.begin();
     auto finalIt = finalData.begin();
     float h = 0;
-    std::valarray<int> diff(0, Lattice::Order());
+    std::array<int, COORD_MAX_ORDER> diff{};
     while (currentIt != currentData.end() && finalIt != finalData.end()) {
         const auto& currentModule = *currentIt;
         const auto& finalModule = *finalIt;
         //std::valarray<int> diff = currentModule.Coords() - finalModule.Coords();
-        diff += currentModule.Coords() - finalModule.Coords();
+        const auto moduleDiff = currentModule.Coords() - finalModule.Coords();
+        for (int i = 0; i < Lattice::Order(); i++) {
+            diff[i] += moduleDiff[i];
+        }
         ++currentIt;
         ++finalIt;
     }
-    for (auto& val : diff) {
-        h += std::abs(val);
+    for (int i = 0; i < Lattice::Order(); i++) {
+        h += std::abs(diff[i]);
     }
     //TODO: find out what the right number is (from testing it must be > 4) (testing was wrong)
     return h / 2;
@@ -272,7 +381,7 @@ int Configuration::SymmetricDifferenceHeuristic(const Configuration* final) cons
     auto& finalData = final->GetModData();
     auto currentIt = currentData.begin();
     auto finalIt = finalData.begin();
-    std::set<std::valarray<int>, ValarrayComparator> unionCoords;
+    std::set<LatticeCoord> unionCoords;
     while (currentIt != currentData.end() && finalIt != finalData.end()) {
         const auto& currentModule = *currentIt;
         const auto& finalModule = *finalIt;
@@ -294,10 +403,10 @@ int Configuration::ChebyshevDistance(const Configuration* final) const {
     while (currentIt != currentData.end() && finalIt != finalData.end()) {
         const auto& currentModule = *currentIt;
         const auto& finalModule = *finalIt;
-        std::valarray<int> diff = currentModule.Coords() - finalModule.Coords();
+        const auto diff = currentModule.Coords() - finalModule.Coords();
         int maxDiff = 0;
-        for (auto& val : diff) {
-            maxDiff = std::max(maxDiff, std::abs(val));
+        for (int i = 0; i < Lattice::Order(); i++) {
+            maxDiff = std::max(maxDiff, std::abs(diff[i]));
         }
         h += maxDiff;
         ++currentIt;
@@ -311,21 +420,23 @@ float Configuration::TrueChebyshevDistance(const Configuration *final) const {
     auto& finalData = final->GetModData();
     auto currentIt = currentData.begin();
     auto finalIt = finalData.begin();
-    std::valarray<int> dist(0, Lattice::Order());
-    float h = 0;
-    std::valarray<int> diff(0, Lattice::Order());
+    std::array<int, COORD_MAX_ORDER> dist{};
+    std::array<int, COORD_MAX_ORDER> diff{};
     while (currentIt != currentData.end() && finalIt != finalData.end()) {
         const auto& currentModule = *currentIt;
         const auto& finalModule = *finalIt;
-        diff += currentModule.Coords() - finalModule.Coords();
+        const auto moduleDiff = currentModule.Coords() - finalModule.Coords();
+        for (int i = 0; i < Lattice::Order(); i++) {
+            diff[i] += moduleDiff[i];
+        }
         ++currentIt;
         ++finalIt;
     }
-    for (int i = 0; i <= Lattice::Order(); ++i) {
+    for (int i = 0; i < Lattice::Order(); ++i) {
         dist[i] += std::abs(diff[i]);
     }
     //TODO: find out what the right number is (from testing it must be > 2) (testing was wrong)
-    return static_cast<float>(*std::max_element(begin(dist), end(dist))) / 2;
+    return static_cast<float>(*std::max_element(dist.begin(), dist.begin() + Lattice::Order())) / 2;
 }
 
 float Configuration::CacheChebyshevDistance(const Configuration *final) const {
@@ -375,13 +486,33 @@ std::vector<Configuration*> ConfigurationSpace::AStar(Configuration* start, cons
     using CompareType = decltype(compare);
     std::priority_queue<Configuration*, std::vector<Configuration*>, CompareType> pq(compare);
     std::unordered_set<HashedState> visited;
+    // When moves have different costs a state may be reached more cheaply after it was first discovered, so the cheapest
+    // known cost of each state is tracked instead and states are pushed again whenever a cheaper path to them is found
+#if !CONFIG_PARALLEL_MOVES
+    const bool weighted = !MoveManager::UniformMoveCosts();
+#else
+    constexpr bool weighted = false;
+#endif
+    std::unordered_map<HashedState, float> bestCosts;
+    ResetLatticeSync();
     start->SetCost(0);
     pq.push(start);
     visited.insert(start->GetHash());
+    if (weighted) {
+        bestCosts.emplace(start->GetHash(), 0);
+    }
+    [[maybe_unused]] const auto statesDiscovered = [&]() {
+        return weighted ? bestCosts.size() : visited.size();
+    };
 
     while (!pq.empty()) {
         Configuration* current = pq.top();
-        Lattice::UpdateFromModuleInfo(current->GetModData());
+        if (weighted && current->GetCost() > bestCosts.at(current->GetHash())) {
+            // A cheaper path to this state was found after it was pushed
+            pq.pop();
+            continue;
+        }
+        SyncLattice(current);
 #if CONFIG_VERBOSE > CS_LOG_NONE
 #if CONFIG_OUTPUT_JSON
         SearchAnalysis::PauseClock();
@@ -391,14 +522,14 @@ std::vector<Configuration*> ConfigurationSpace::AStar(Configuration* start, cons
 #if CONFIG_VERBOSE > CS_LOG_FINAL_DEPTH
             std::cout << "A* Depth: " << current->depth << std::endl
                     << "Duplicate states Avoided: " << dupesAvoided << std::endl
-                    << "States Discovered: " << visited.size() << std::endl
+                    << "States Discovered: " << statesDiscovered() << std::endl
                     << "States Processed: " << statesProcessed << std::endl
                     << Lattice::ToString() << std::endl;
 #if CONFIG_OUTPUT_JSON
             SearchAnalysis::EnterGraph("AStarDepthOverTime");
             SearchAnalysis::InsertTimePoint(depth);
             SearchAnalysis::EnterGraph("AStarStatesOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
+            SearchAnalysis::InsertTimePoint(statesDiscovered());
 #endif
 #endif
         }
@@ -413,33 +544,58 @@ std::vector<Configuration*> ConfigurationSpace::AStar(Configuration* start, cons
 #if CONFIG_OUTPUT_JSON
             SearchAnalysis::PauseClock();
 #endif
-            std::cout << "A* Final Depth: " << current->depth << std::endl
-                    << "Duplicate states Avoided: " << dupesAvoided << std::endl
-                    << "States Discovered: " << visited.size() << std::endl
+            std::cout << "A* Final Depth: " << current->depth << std::endl;
+            if (weighted) {
+                std::cout << "A* Final Cost: " << current->GetCost() << std::endl;
+            }
+            std::cout << "Duplicate states Avoided: " << dupesAvoided << std::endl
+                    << "States Discovered: " << statesDiscovered() << std::endl
                     << "States Processed: " << statesProcessed << std::endl
                     << Lattice::ToString() << std::endl;
 #if CONFIG_OUTPUT_JSON
             SearchAnalysis::EnterGraph("AStarDepthOverTime");
             SearchAnalysis::InsertTimePoint(depth);
             SearchAnalysis::EnterGraph("AStarStatesOverTime");
-            SearchAnalysis::InsertTimePoint(visited.size());
+            SearchAnalysis::InsertTimePoint(statesDiscovered());
 #endif
 #endif
             return FindPath(start, current);
         }
+        std::vector<Transition> transitions;
 #if !CONFIG_PARALLEL_MOVES
-        auto adjList = current->MakeAllMoves();
+        auto adjList = current->MakeAllMoves(transitions);
 #else
         auto adjList = MoveManager::MakeAllParallelMoves(visited);
+        transitions.resize(adjList.size());
 #endif
         statesProcessed++;
-        for (const auto& moduleInfo : adjList) {
+        for (int i = 0; i < adjList.size(); i++) {
+            const auto& moduleInfo = adjList[i];
 #if !CONFIG_PARALLEL_MOVES
+            const float cost = current->GetCost() + MoveManager::GetMove(transitions[i].moveId)->Cost();
+            if (weighted) {
+                HashedState hashedState(moduleInfo);
+                if (const auto [known, inserted] = bestCosts.try_emplace(hashedState, cost); !inserted) {
+                    if (known->second <= cost) {
+                        dupesAvoided++;
+                        continue;
+                    }
+                    known->second = cost;
+                }
+                auto nextConfiguration = current->AddEdge(moduleInfo, transitions[i]);
+                nextConfiguration->SetParent(current);
+                nextConfiguration->SetCost(cost);
+                pq.push(nextConfiguration);
+                nextConfiguration->depth = current->depth + 1;
+                continue;
+            }
             if (HashedState hashedState(moduleInfo); visited.find(hashedState) == visited.end()) {
+#else
+            const float cost = current->GetCost() + 1;
 #endif
-                auto nextConfiguration = current->AddEdge(moduleInfo);
+                auto nextConfiguration = current->AddEdge(moduleInfo, transitions[i]);
                 nextConfiguration->SetParent(current);
-                nextConfiguration->SetCost(current->GetCost() + 1);
+                nextConfiguration->SetCost(cost);
                 pq.push(nextConfiguration);
                 nextConfiguration->depth = current->depth + 1;
 #if !CONFIG_PARALLEL_MOVES
@@ -500,6 +656,7 @@ Configuration ConfigurationSpace::GenerateRandomFinal(const int targetMoves) {
             // If no adjacent state was found, return early
             std::cerr << "GenerateRandomFinal returning early (" << i << "/" << targetMoves << " moves) due to lack of new moves" << std::endl;
             Lattice::UpdateFromModuleInfo(initialState);
+            ResetLatticeSync();
             return current;
         }
         // Otherwise, update lattice with new state and resume loop
@@ -509,5 +666,41 @@ Configuration ConfigurationSpace::GenerateRandomFinal(const int targetMoves) {
 
     // Reset lattice to original state and return
     Lattice::UpdateFromModuleInfo(initialState);
+    ResetLatticeSync();
     return Configuration(nextState);
-}
\ No newline at end of file
+}
+
+std::vector<std::uint64_t> ConfigurationSpace::ExhaustiveLayerCounts() {
+    const StateRanker ranker;
+    if (!ranker.Supported() || ranker.StateCount() / 4 > CONFIG_DENSE_VISITED_MAX_BYTES) {
+        std::cerr << "State space can't be ranked or is too large, exhaustive search skipped." << std::endl;
+        return {};
+    }
+    const std::set<ModuleData> initialState = Lattice::GetModuleInfo();
+    DenseDepthArray depths(ranker.StateCount());
+    depths.Set(ranker.Rank(initialState), 0);
+    std::vector<std::uint64_t> layerCounts = {1};
+    for (int layer = 0; layerCounts.back() != 0; layer++) {
+        std::uint64_t nextLayerCount = 0;
+        // Depths are stored mod 3, so states of the current layer can be told apart from both neighboring layers
+        for (std::uint64_t rank = 0; rank < ranker.StateCount(); rank++) {
+            if (depths.Get(rank) != DenseDepthArray::Encode(layer)) continue;
+            const Configuration current(ranker.Unrank(rank));
+            for (const auto& moduleInfo : current.MakeAllMoves()) {
+                if (const auto nextRank = ranker.Rank(moduleInfo); depths.Get(nextRank) == DenseDepthArray::UNVISITED) {
+                    depths.Set(nextRank, layer + 1);
+                    nextLayerCount++;
+                }
+            }
+        }
+#if CONFIG_VERBOSE > CS_LOG_FINAL_DEPTH
+        std::cout << "Exhaustive Search Depth: " << layer << std::endl
+        << "States at Depth: " << layerCounts.back() << std::endl;
+#endif
+        layerCounts.push_back(nextLayerCount);
+    }
+    layerCounts.pop_back();
+    Lattice::UpdateFromModuleInfo(initialState);
+    ResetLatticeSync();
+    return layerCounts;
+}
@@ -18,6 +18,14 @@
  * This is for permitting multiple moves in one step, not threading the search!
  */
 #define CONFIG_PARALLEL_MOVES false
+/* Dense Visited Set Configuration
+ * When set to true, BFS ranks states perfectly and tracks visited states using one bit per possible state instead of
+ * hashing, as long as the bitmap fits within CONFIG_DENSE_VISITED_MAX_BYTES. The whole bitmap is allocated up front,
+ * so this is only worth it for exhaustive searches of small bounded regions. The same limit applies to the depth array
+ * used by exhaustive search.
+ */
+#define CONFIG_DENSE_VISITED false
+#define CONFIG_DENSE_VISITED_MAX_BYTES (1 << 24)
 /* JSON Output Configuration
  * In order to output JSON successfully logging must be enabled for every depth
  */
@@ -61,13 +69,26 @@ struct std::hash<HashedState> {
     size_t operator()(const HashedState& state) const noexcept;
 };
 
+// A single module moving from one position to another
+struct Transition {
+    // ID of the module that moved when the transition was recorded, -1 if the transition is unknown
+    int moduleId = -1;
+    LatticeCoord from;
+    LatticeCoord to;
+    // ID of the move that was made, -1 if it isn't known
+    int moveId = -1;
+};
+
 // For tracking the state of a lattice
 class Configuration {
 private:
     Configuration* parent = nullptr;
     std::vector<Configuration*> next;
     HashedState hash;
-    int cost;
+    // Cost of the path from the start of the search to this configuration
+    float cost = 0;
+    // Move that turns the parent configuration into this one
+    Transition transition;
 public:
     int depth = 0;
 
@@ -78,10 +99,16 @@ public:
     [[nodiscard]]
     std::vector<std::set<ModuleData>> MakeAllMoves() const;
 
+    // Same as MakeAllMoves, also records the move leading to each adjacent state
+    std::vector<std::set<ModuleData>> MakeAllMoves(std::vector<Transition>& transitions) const;
+
     [[nodiscard]]
     std::vector<std::set<ModuleData>> MakeAllMovesForAllVertices() const;
 
-    Configuration* AddEdge(const std::set<ModuleData>& modData);
+    Configuration* AddEdge(const std::set<ModuleData>& modData, const Transition& transition = {});
+
+    [[nodiscard]]
+    const Transition& GetTransition() const;
 
     [[nodiscard]]
     Configuration* GetParent() const;
@@ -99,9 +126,9 @@ public:
 
     friend std::ostream& operator<<(std::ostream& out, const Configuration& config);
 
-    int GetCost() const;
+    float GetCost() const;
 
-    void SetCost(int cost);
+    void SetCost(float cost);
 
     template <typename Heuristic>
     static auto CompareConfiguration(const Configuration* final, Heuristic heuristic);
@@ -128,6 +155,14 @@ public:
 namespace ConfigurationSpace {
     extern int depth;
 
+    // Bring the lattice to the state of a configuration. If the lattice was last synced to a configuration in the same
+    // search tree, only the moves between the two are undone and redone, otherwise the whole lattice is updated.
+    void SyncLattice(const Configuration* configuration);
+
+    // Forget which configuration the lattice was last synced to, needed whenever the lattice is updated without
+    // SyncLattice or the configuration it was synced to is destroyed
+    void ResetLatticeSync();
+
     std::vector<Configuration*> BFS(Configuration* start, const Configuration* final);
 
     std::vector<Configuration*> AStar(Configuration* start, const Configuration* final);
@@ -135,6 +170,10 @@ namespace ConfigurationSpace {
     std::vector<Configuration*> FindPath(Configuration* start, Configuration* final);
 
     Configuration GenerateRandomFinal(int targetMoves = 8);
+
+    // Exhaustively explore every state reachable from the current lattice state using a 2-bit depth array indexed by
+    // state rank, returns the number of states at each depth (empty if the state space can't be ranked)
+    std::vector<std::uint64_t> ExhaustiveLayerCounts();
 }
 
 #endif //MODULAR_ROBOTICS_CONFIGURATIONSPACE_H
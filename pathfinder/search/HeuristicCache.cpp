@@ -1,19 +1,24 @@
 #include "HeuristicCache.h"
+#include <algorithm>
 #include <queue>
 #include <execution>
+#include <map>
+#include <numeric>
+#include <utility>
+#include "../coordtensor/BitTensor.h"
 #include "../lattice/Lattice.h"
 #include "../moves/MoveManager.h"
 
 constexpr float INVALID_WEIGHT = 999;
 
-IHeuristicCache::IHeuristicCache(): weightCache(Lattice::Order(), Lattice::AxisSize(), INVALID_WEIGHT) {}
+IHeuristicCache::IHeuristicCache(): weightCache(Lattice::AxisSizes(), INVALID_WEIGHT, {}, Lattice::coordTensor.Storage()) {}
 
-float IHeuristicCache::operator[](const std::valarray<int> &coords) const {
+float IHeuristicCache::operator[](const LatticeCoord& coords) const {
     return weightCache[coords];
 }
 
 void ChebyshevHeuristicCache::ChebyshevEnqueueAdjacent(std::queue<SearchCoord>& coordQueue, const SearchCoord& coordInfo) {
-    std::vector<std::valarray<int>> adjCoords;
+    std::vector<LatticeCoord> adjCoords;
     adjCoords.push_back(coordInfo.coords);
     for (int i = 0; i < Lattice::Order(); i++) {
         auto adjCoordsTemp = adjCoords;
@@ -36,7 +41,7 @@ ChebyshevHeuristicCache::ChebyshevHeuristicCache(const std::set<ModuleData>& des
         std::queue<SearchCoord> coordQueue;
         coordQueue.push({desiredModuleData.Coords(), 0});
         while (!coordQueue.empty()) {
-            std::valarray<int> coords = coordQueue.front().coords;
+            const auto coords = coordQueue.front().coords;
             const auto depth = coordQueue.front().depth;
             if (const auto weight = weightCache[coords]; depth < weight) {
                 weightCache[coords] = depth;
@@ -48,22 +53,25 @@ ChebyshevHeuristicCache::ChebyshevHeuristicCache(const std::set<ModuleData>& des
             coordQueue.pop();
         }
     }
+#if CONFIG_HEURISTIC_CACHE_PRINT
+    // Print weight tensor
     std::cout << "Weight Cache:";
-    for (int i = 0; i < weightCache.GetArrayInternal().size(); i++) {
-        if (i % Lattice::AxisSize() == 0) std::cout << std::endl;
-        if (weightCache.GetArrayInternal()[i] < 10) {
-            std::cout << weightCache.GetArrayInternal()[i];
-        } else if (weightCache.GetArrayInternal()[i] == INVALID_WEIGHT) {
+    for (int i = 0; i < weightCache.Size(); i++) {
+        if (i % Lattice::AxisSizes()[0] == 0) std::cout << std::endl;
+        if (const auto weight = std::as_const(weightCache).GetElementDirect(i); weight < 10) {
+            std::cout << weight;
+        } else if (weight == INVALID_WEIGHT) {
             std::cout << "#";
         } else {
             std::cout << " ";
         }
     }
     std::cout << std::endl;
+#endif
 }
 
 void ManhattanEnqueueAdjacentInternal(std::queue<SearchCoord>& coordQueue, const SearchCoord& coordInfo) {
-    std::vector<std::valarray<int>> adjCoords;
+    std::vector<LatticeCoord> adjCoords;
     adjCoords.push_back(coordInfo.coords);
     // for (int i = 0; i < Lattice::Order(); i++) {
     //     auto adjCoordsTemp = adjCoords;
@@ -91,7 +99,7 @@ void ManhattanEnqueueAdjacentInternal(std::queue<SearchCoord>& coordQueue, const
 }
 
 void ChebyshevEnqueueAdjacentInternal(std::queue<SearchCoord>& coordQueue, const SearchCoord& coordInfo) {
-    std::vector<std::valarray<int>> adjCoords;
+    std::vector<LatticeCoord> adjCoords;
     adjCoords.push_back(coordInfo.coords);
     for (int i = 0; i < Lattice::Order(); i++) {
         auto adjCoordsTemp = adjCoords;
@@ -108,13 +116,21 @@ void ChebyshevEnqueueAdjacentInternal(std::queue<SearchCoord>& coordQueue, const
     }
 }
 
+void HexagonEnqueueAdjacentInternal(std::queue<SearchCoord>& coordQueue, const SearchCoord& coordInfo) {
+    for (const auto& offset : HexagonGeometry::offsets) {
+        const auto coord = coordInfo.coords + offset;
+        if (Lattice::coordTensor[coord] == OUT_OF_BOUNDS) continue;
+        coordQueue.push({coord, coordInfo.depth + 1});
+    }
+}
+
 CoordTensor<int> BuildInternalDistanceCache() {
-    CoordTensor<int> cache(Lattice::Order(), Lattice::AxisSize(), INVALID_WEIGHT);
+    CoordTensor<int> cache(Lattice::AxisSizes(), INVALID_WEIGHT, {}, Lattice::coordTensor.Storage());
     for (const auto& staticModule : ModuleIdManager::StaticModules()) {
         std::queue<SearchCoord> coordQueue;
         coordQueue.push({staticModule.coords, 0});
         while (!coordQueue.empty()) {
-            std::valarray<int> coords = coordQueue.front().coords;
+            const auto coords = coordQueue.front().coords;
             const auto depth = coordQueue.front().depth;
             if (static_cast<int>(depth) > ModuleIdManager::MinStaticID()) {
                 while (!coordQueue.empty()) {
@@ -128,29 +144,38 @@ CoordTensor<int> BuildInternalDistanceCache() {
                 coordQueue.pop();
                 continue;
             }
-#if LATTICE_RD_EDGECHECK
-            // 90% sure Chebyshev distance should work for rhombic dodecahedra edge checking
-            ChebyshevEnqueueAdjacentInternal(coordQueue, coordQueue.front());
-#else
-            // Manhattan distance works for regular edge checking
-            ManhattanEnqueueAdjacentInternal(coordQueue, coordQueue.front());
-#endif
+            if (Lattice::geometry == GEOMETRY_RHOMBIC_DODECAHEDRON) {
+                // 90% sure Chebyshev distance should work for rhombic dodecahedra edge checking
+                ChebyshevEnqueueAdjacentInternal(coordQueue, coordQueue.front());
+            } else if (Lattice::geometry == GEOMETRY_HEXAGON) {
+                HexagonEnqueueAdjacentInternal(coordQueue, coordQueue.front());
+            } else {
+                // Manhattan distance works for regular edge checking
+                ManhattanEnqueueAdjacentInternal(coordQueue, coordQueue.front());
+            }
             coordQueue.pop();
         }
     }
+#if CONFIG_HEURISTIC_CACHE_OPTIMIZATION
+    // Mark unreachable cells as out of bounds, skipped for sparse lattices as it would allocate every unreachable cell
+    for (int i = 0; i < cache.Size() && Lattice::coordTensor.Storage() == TENSOR_DENSE; i++) {
+        if (std::as_const(cache).GetElementDirect(i) == INVALID_WEIGHT &&
+            std::as_const(Lattice::coordTensor)[cache.CoordsFromIndex(i)] < ModuleIdManager::MinStaticID()) {
+            Lattice::coordTensor[cache.CoordsFromIndex(i)] = OUT_OF_BOUNDS;
+        }
+    }
+#endif
+#if CONFIG_HEURISTIC_CACHE_PRINT
     // Print distance tensor
     std::cout << "Distance Cache:";
-    for (int i = 0; i < cache.GetArrayInternal().size(); i++) {
-        if (i % Lattice::AxisSize() == 0) std::cout << std::endl;
-        if (cache.GetArrayInternal()[i] < 10) {
-            std::cout << cache.GetArrayInternal()[i];
-        } else if (cache.GetArrayInternal()[i] == INVALID_WEIGHT) {
-            if (Lattice::coordTensor.GetElementDirect(i) >= ModuleIdManager::MinStaticID()) {
+    for (int i = 0; i < cache.Size(); i++) {
+        if (i % Lattice::AxisSizes()[0] == 0) std::cout << std::endl;
+        if (const auto weight = std::as_const(cache).GetElementDirect(i); weight < 10) {
+            std::cout << weight;
+        } else if (weight == INVALID_WEIGHT) {
+            if (std::as_const(Lattice::coordTensor)[cache.CoordsFromIndex(i)] >= ModuleIdManager::MinStaticID()) {
                 std::cout << "#";
             } else {
-#if CONFIG_HEURISTIC_CACHE_OPTIMIZATION
-                Lattice::coordTensor.GetElementDirect(i) = OUT_OF_BOUNDS;
-#endif
                 std::cout << "⋅";
             }
         } else {
@@ -158,6 +183,7 @@ CoordTensor<int> BuildInternalDistanceCache() {
         }
     }
     std::cout << std::endl;
+#endif
     return cache;
 }
 
@@ -169,7 +195,7 @@ void MoveOffsetHeuristicCache::MoveOffsetEnqueueAdjacent(std::queue<SearchCoord>
 #if CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
     static CoordTensor<int> internalDistanceCache = BuildInternalDistanceCache();
 #endif
-    std::vector<std::valarray<int>> adjCoords;
+    std::vector<LatticeCoord> adjCoords;
     adjCoords.push_back(coordInfo.coords);
     auto adjCoordsTemp = adjCoords;
     for (auto adj : adjCoordsTemp) {
@@ -213,32 +239,25 @@ MoveOffsetHeuristicCache::MoveOffsetHeuristicCache(const std::set<ModuleData> &d
     constexpr std::hash<ModuleData> moduleHash;
     currentHelp = ModuleIdManager::MinStaticID();
     std::unordered_map<std::size_t, int> helpMap;
-    std::vector<std::valarray<int>> desiredPositions;
+    std::vector<LatticeCoord> desiredPositions;
     // Get desired positions
     for (const auto& desiredModuleData : desiredState) {
         desiredPositions.push_back(desiredModuleData.Coords());
     }
     // Find out which non-static modules can interact
+    BitTensor internalVisitTensor(Lattice::AxisSizes());
     for (const auto& desiredModuleData : desiredState) {
-        CoordTensor<bool> internalVisitTensor(Lattice::Order(), Lattice::AxisSize(), false);
+        internalVisitTensor.Fill(false);
         std::queue<SearchCoord> coordQueue;
         coordQueue.push({desiredModuleData.Coords()});
-        // internalVisitTensor[desiredModuleData.Coords()] = true;
         while (!coordQueue.empty()) {
-            if (internalVisitTensor[coordQueue.front().coords]) {
+            if (internalVisitTensor.TestAndSet(coordQueue.front().coords)) {
                 coordQueue.pop();
                 continue;
             }
-            internalVisitTensor[coordQueue.front().coords] = true;
             //if (desiredPositions.contains(coordQueue.front().coords)) {
-            if (std::any_of(std::execution::par_unseq, desiredPositions.begin(), desiredPositions.end(), [&](std::valarray<int>& coord) {
-                std::valarray valArrComparison = coord == coordQueue.front().coords;
-                for (const auto result : valArrComparison) {
-                    if (!result) {
-                        return false;
-                    }
-                }
-                return true;
+            if (std::any_of(std::execution::par_unseq, desiredPositions.begin(), desiredPositions.end(), [&](const LatticeCoord& coord) {
+                return coord == coordQueue.front().coords;
             })) {
                 if (!helpMap.contains(moduleHash(desiredModuleData))) {
                     helpMap[moduleHash(desiredModuleData)] = 0;
@@ -259,7 +278,7 @@ MoveOffsetHeuristicCache::MoveOffsetHeuristicCache(const std::set<ModuleData> &d
         std::queue<SearchCoord> coordQueue;
         coordQueue.push({desiredModuleData.Coords(), 0});
         while (!coordQueue.empty()) {
-            std::valarray<int> coords = coordQueue.front().coords;
+            const auto coords = coordQueue.front().coords;
             const auto depth = coordQueue.front().depth;
             if (const auto weight = weightCache[coords]; depth < weight) {
                 weightCache[coords] = depth;
@@ -275,19 +294,26 @@ MoveOffsetHeuristicCache::MoveOffsetHeuristicCache(const std::set<ModuleData> &d
     for (const auto& mod : ModuleIdManager::FreeModules()) {
         Lattice::coordTensor[mod.coords] = mod.id;
     }
+#if CONFIG_HEURISTIC_CACHE_OPTIMIZATION
+    // Mark unreachable cells as out of bounds, skipped for sparse lattices as it would allocate every unreachable cell
+    for (int i = 0; i < weightCache.Size() && Lattice::coordTensor.Storage() == TENSOR_DENSE; i++) {
+        if (std::as_const(weightCache).GetElementDirect(i) == INVALID_WEIGHT &&
+            std::as_const(Lattice::coordTensor)[weightCache.CoordsFromIndex(i)] < ModuleIdManager::MinStaticID()) {
+            Lattice::coordTensor[weightCache.CoordsFromIndex(i)] = OUT_OF_BOUNDS;
+        }
+    }
+#endif
+#if CONFIG_HEURISTIC_CACHE_PRINT
     // Print weight tensor
     std::cout << "Weight Cache:";
-    for (int i = 0; i < weightCache.GetArrayInternal().size(); i++) {
-        if (i % Lattice::AxisSize() == 0) std::cout << std::endl;
-        if (weightCache.GetArrayInternal()[i] < 10) {
-            std::cout << weightCache.GetArrayInternal()[i];
-        } else if (weightCache.GetArrayInternal()[i] == INVALID_WEIGHT) {
-            if (Lattice::coordTensor.GetElementDirect(i) >= ModuleIdManager::MinStaticID()) {
+    for (int i = 0; i < weightCache.Size(); i++) {
+        if (i % Lattice::AxisSizes()[0] == 0) std::cout << std::endl;
+        if (const auto weight = std::as_const(weightCache).GetElementDirect(i); weight < 10) {
+            std::cout << weight;
+        } else if (weight == INVALID_WEIGHT) {
+            if (std::as_const(Lattice::coordTensor)[weightCache.CoordsFromIndex(i)] >= ModuleIdManager::MinStaticID()) {
                 std::cout << "#";
             } else {
-#if CONFIG_HEURISTIC_CACHE_OPTIMIZATION
-                Lattice::coordTensor.GetElementDirect(i) = OUT_OF_BOUNDS;
-#endif
                 std::cout << "⋅";
             }
         } else {
@@ -295,47 +321,53 @@ MoveOffsetHeuristicCache::MoveOffsetHeuristicCache(const std::set<ModuleData> &d
         }
     }
     std::cout << std::endl;
+#endif
 }
 
 std::unordered_map<std::uint_fast64_t, int> MoveOffsetPropertyHeuristicCache::propConversionMap;
 
-#if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS
-int MoveOffsetPropertyHeuristicCache::currentHelp = 0;
-#endif
-
-void MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyEnqueueAdjacent(std::queue<SearchCoordProp>& coordPropQueue, const SearchCoordProp& coordPropInfo) {
 #if CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
-    static CoordTensor<int> internalDistanceCache = BuildInternalDistanceCache();
+const CoordTensor<int>& MoveOffsetPropertyHeuristicCache::InternalDistanceCache() {
+    static const CoordTensor<int> internalDistanceCache = BuildInternalDistanceCache();
+    return internalDistanceCache;
+}
 #endif
-    std::vector<std::valarray<int>> adjCoords;
-    adjCoords.push_back(coordPropInfo.coords);
-    auto adjCoordsTemp = adjCoords;
-    for (auto adj : adjCoordsTemp) {
-        for (const auto& offset : MoveManager::_offsets) {
+
+template<typename F>
+void MoveOffsetPropertyHeuristicCache::MoveOffsetPropertySearch(const std::vector<LatticeCoord>& sources, const int help, F&& visit) {
+    const auto& coordTensor = std::as_const(Lattice::coordTensor);
+    BitTensor visitTensor(Lattice::AxisSizes());
+    std::vector<LatticeCoord> frontier;
+    for (const auto& source : sources) {
+        if (!visitTensor.TestAndSet(source)) {
+            frontier.push_back(source);
+        }
+    }
+    std::vector<LatticeCoord> next;
+    for (int depth = 0; !frontier.empty(); depth++) {
+        for (const auto& coords : frontier) {
+            visit(coords, depth);
+            for (const auto& offset : MoveManager::_offsets) {
+                const auto adj = coords + offset;
 #if CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
-#if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS
-            if (internalDistanceCache[adj + offset] > currentHelp) continue;
-#else
-            if (internalDistanceCache[adj + offset] > ModuleIdManager::MinStaticID()) continue;
-#endif
+                if (InternalDistanceCache()[adj] > help) continue;
 #endif
-            if (std::any_of(std::execution::par_unseq,MoveManager::_movesByOffset[offset].begin(), MoveManager::_movesByOffset[offset].end(), [&](MoveBase* move) {
+                if (coordTensor[adj] == OUT_OF_BOUNDS || coordTensor[adj] >= ModuleIdManager::MinStaticID() ||
+                    visitTensor[adj]) continue;
+                if (std::ranges::any_of(std::as_const(MoveManager::_movesByOffset)[offset], [&](MoveBase* move) {
 #if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS
-                return move->FreeSpaceCheckHelpLimit(Lattice::coordTensor, adj, internalDistanceCache, currentHelp);
+                    return move->FreeSpaceCheckHelpLimit(coordTensor, coords, InternalDistanceCache(), help);
 #else
-                return move->FreeSpaceCheck(Lattice::coordTensor, adj);
+                    return move->FreeSpaceCheck(coordTensor, coords);
 #endif
-            })) {
-                adj += offset;
-                adjCoords.push_back(adj);
-                adj -= offset;
+                })) {
+                    visitTensor.Set(adj, true);
+                    next.push_back(adj);
+                }
             }
         }
-    }
-    for (const auto& coord : adjCoords) {
-        if (Lattice::coordTensor[coord] == OUT_OF_BOUNDS || Lattice::coordTensor[coord] >=
-            ModuleIdManager::MinStaticID()) continue;
-        coordPropQueue.push({coord, coordPropInfo.depth + 1, coordPropInfo.propInt});
+        std::swap(frontier, next);
+        next.clear();
     }
 }
 
@@ -348,96 +380,89 @@ MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyHeuristicCache(const std::se
             propIndex++;
         }
     }
-    // Resize weight cache to account for property axis (increase order by 1 and adjust axis size only if necessary)
-    if (propIndex > Lattice::AxisSize()) {
-        weightCache = CoordTensor<float>(Lattice::Order() + 1, propIndex, INVALID_WEIGHT);
-    } else {
-        weightCache = CoordTensor<float>(Lattice::Order() + 1, Lattice::AxisSize(), INVALID_WEIGHT);
-    }
+    // Resize weight cache to account for property axis (increase order by 1, with one entry per unique property)
+    auto weightCacheSizes = Lattice::AxisSizes();
+    weightCacheSizes.push_back(propIndex);
+    weightCache = CoordTensor<float>(weightCacheSizes, INVALID_WEIGHT, {}, Lattice::coordTensor.Storage());
     // Temporarily remove non-static modules from lattice
     for (const auto& mod : ModuleIdManager::FreeModules()) {
         Lattice::coordTensor[mod.coords] = FREE_SPACE;
     }
+#if CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
+    // Has to be built before searching in parallel since building it changes the lattice
+    InternalDistanceCache();
+#endif
+    const std::vector<const ModuleData*> desiredModules = [&desiredState]() {
+        std::vector<const ModuleData*> modules;
+        for (const auto& desiredModuleData : desiredState) {
+            modules.push_back(&desiredModuleData);
+        }
+        return modules;
+    }();
+    std::vector<int> moduleIndices(desiredModules.size());
+    std::iota(moduleIndices.begin(), moduleIndices.end(), 0);
+    std::vector<int> helps(desiredModules.size(), ModuleIdManager::MinStaticID());
 #if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS
-    constexpr std::hash<ModuleData> moduleHash;
-    currentHelp = ModuleIdManager::MinStaticID();
-    std::unordered_map<std::size_t, int> helpMap;
-    std::vector<std::valarray<int>> desiredPositions;
-    // Get desired positions
-    for (const auto& desiredModuleData : desiredState) {
-        desiredPositions.push_back(desiredModuleData.Coords());
+    // Find out which non-static modules can interact, by counting the desired positions reachable from each one
+    BitTensor desiredTensor(Lattice::AxisSizes());
+    for (const auto* desiredModuleData : desiredModules) {
+        desiredTensor.Set(desiredModuleData->Coords(), true);
     }
-    // Find out which non-static modules can interact
-    for (const auto& desiredModuleData : desiredState) {
-        CoordTensor<bool> internalVisitTensor(Lattice::Order(), Lattice::AxisSize(), false);
-        std::queue<SearchCoordProp> coordQueue;
-        coordQueue.push({desiredModuleData.Coords()});
-        // internalVisitTensor[desiredModuleData.Coords()] = true;
-        while (!coordQueue.empty()) {
-            if (internalVisitTensor[coordQueue.front().coords]) {
-                coordQueue.pop();
-                continue;
+    std::for_each(std::execution::par, moduleIndices.begin(), moduleIndices.end(), [&](const int i) {
+        int help = 0;
+        MoveOffsetPropertySearch({desiredModules[i]->Coords()}, ModuleIdManager::MinStaticID(),
+                                 [&desiredTensor, &help](const LatticeCoord& coords, int) {
+            if (desiredTensor[coords]) {
+                help++;
             }
-            internalVisitTensor[coordQueue.front().coords] = true;
-            //if (desiredPositions.contains(coordQueue.front().coords)) {
-            if (std::any_of(std::execution::par_unseq, desiredPositions.begin(), desiredPositions.end(), [&](std::valarray<int>& coord) {
-                std::valarray valArrComparison = coord == coordQueue.front().coords;
-                for (const auto result : valArrComparison) {
-                    if (!result) {
-                        return false;
-                    }
-                }
-                return true;
-            })) {
-                if (!helpMap.contains(moduleHash(desiredModuleData))) {
-                    helpMap[moduleHash(desiredModuleData)] = 1;
-                } else {
-                    helpMap[moduleHash(desiredModuleData)]++;
-                }
-            }
-            MoveOffsetPropertyEnqueueAdjacent(coordQueue, coordQueue.front());
-            coordQueue.pop();
-        }
-    }
+        });
+        helps[i] = help;
+    });
     std::cout << "Acquired Help Values." << std::endl;
 #endif
-    // Populate weight tensor
-    for (const auto& desiredModuleData : desiredState) {
-#if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS
-        currentHelp = helpMap[moduleHash(desiredModuleData)];
-#endif
-        std::queue<SearchCoordProp> coordQueue;
-        coordQueue.push({desiredModuleData.Coords(), 0, (desiredModuleData.Properties().AsInt())});
-        while (!coordQueue.empty()) {
-            //std::valarray<int> coords = coordQueue.front().coords;
-            std::valarray<int> coordProps(Lattice::Order() + 1, 0);
-            for (int i = 0; i < Lattice::Order(); i++) {
-                coordProps[i] = coordQueue.front().coords[i];
-            }
-            coordProps[Lattice::Order()] = propConversionMap[coordQueue.front().propInt];
-            const auto depth = coordQueue.front().depth;
-            if (const auto weight = weightCache[coordProps]; depth < weight) {
-                weightCache[coordProps] = depth;
-            } else if (depth > weight) {
-                coordQueue.pop();
-                continue;
+    // Desired modules with the same property and help are searched from together, the weight of a cell is then the
+    // lowest depth any search of its property reached it at
+    std::map<std::pair<int, int>, std::vector<LatticeCoord>> sourceMap;
+    for (const int i : moduleIndices) {
+        sourceMap[{propConversionMap[desiredModules[i]->Properties().AsInt()], helps[i]}].push_back(desiredModules[i]->Coords());
+    }
+    const std::vector<std::pair<std::pair<int, int>, std::vector<LatticeCoord>>> sources(sourceMap.begin(), sourceMap.end());
+    std::vector<std::vector<std::pair<LatticeCoord, int>>> reached(sources.size());
+    std::vector<int> sourceIndices(sources.size());
+    std::iota(sourceIndices.begin(), sourceIndices.end(), 0);
+    std::for_each(std::execution::par, sourceIndices.begin(), sourceIndices.end(), [&](const int i) {
+        MoveOffsetPropertySearch(sources[i].second, sources[i].first.second, [&cells = reached[i]](const LatticeCoord& coords, const int depth) {
+            cells.emplace_back(coords, depth);
+        });
+    });
+    // Populate weight tensor, done serially as writing to a sparse tensor may allocate
+    for (int i = 0; i < sources.size(); i++) {
+        Coord<COORD_MAX_ORDER + 1> coordProps;
+        coordProps[Lattice::Order()] = sources[i].first.first;
+        for (const auto& [coords, depth] : reached[i]) {
+            for (int j = 0; j < Lattice::Order(); j++) {
+                coordProps[j] = coords[j];
             }
-            MoveOffsetPropertyEnqueueAdjacent(coordQueue, coordQueue.front());
-            coordQueue.pop();
+            auto& weight = weightCache[coordProps];
+            weight = std::min(weight, static_cast<float>(depth));
         }
     }
 #if CONFIG_HEURISTIC_CACHE_OPTIMIZATION
     // Optimize lattice using cache info
-    for (int i = 0; i < Lattice::coordTensor.GetArrayInternal().size(); i++) {
+    // Skipped for sparse lattices, as it would allocate every unreachable cell
+    for (int i = 0; i < Lattice::coordTensor.Size() && Lattice::coordTensor.Storage() == TENSOR_DENSE; i++) {
+        if (Lattice::coordTensor.IsPadding(i)) continue;
+        Coord<COORD_MAX_ORDER + 1> coordProps = Lattice::coordTensor.CoordsFromIndex<COORD_MAX_ORDER + 1>(i);
         bool reachable = false;
         for (int prop = 0; prop < propIndex; prop++) {
-            if (weightCache.GetArrayInternal()[i + prop * Lattice::coordTensor.GetArrayInternal().size()] != INVALID_WEIGHT) {
+            coordProps[Lattice::Order()] = prop;
+            if (std::as_const(weightCache)[coordProps] != INVALID_WEIGHT) {
                 reachable = true;
                 break;
             }
         }
-        if (!reachable && Lattice::coordTensor.GetArrayInternal()[i] <= FREE_SPACE) {
-            Lattice::coordTensor[Lattice::coordTensor.CoordsFromIndex(i)] = OUT_OF_BOUNDS;
+        if (!reachable && std::as_const(Lattice::coordTensor).GetElementDirect(i) <= FREE_SPACE) {
+            Lattice::coordTensor.GetElementDirect(i) = OUT_OF_BOUNDS;
         }
     }
 #endif
@@ -445,17 +470,22 @@ MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyHeuristicCache(const std::se
     for (const auto& mod : ModuleIdManager::FreeModules()) {
         Lattice::coordTensor[mod.coords] = mod.id;
     }
+#if CONFIG_HEURISTIC_CACHE_PRINT
     // Print weight tensor
-    auto maxIndex = propIndex * Lattice::coordTensor.GetArrayInternal().size();
     std::cout << "Weight Cache:";
-    for (int i = 0; i < maxIndex; i++) {
-        if (i % Lattice::AxisSize() == 0) std::cout << std::endl;
-        if (weightCache.GetArrayInternal()[i] < 10) {
-            std::cout << weightCache.GetArrayInternal()[i];
-        } else if (weightCache.GetArrayInternal()[i] == INVALID_WEIGHT) {
-            if (Lattice::coordTensor.GetArrayInternal()[i % Lattice::coordTensor.GetArrayInternal().size()] >= ModuleIdManager::MinStaticID()) {
+    for (int i = 0; i < weightCache.Size(); i++) {
+        if (i % Lattice::AxisSizes()[0] == 0) std::cout << std::endl;
+        if (const auto weight = std::as_const(weightCache).GetElementDirect(i); weight < 10) {
+            std::cout << weight;
+        } else if (weight == INVALID_WEIGHT) {
+            const auto coordProps = weightCache.CoordsFromIndex<COORD_MAX_ORDER + 1>(i);
+            LatticeCoord coords;
+            for (int j = 0; j < Lattice::Order(); j++) {
+                coords[j] = static_cast<std::int16_t>(coordProps[j]);
+            }
+            if (const auto id = std::as_const(Lattice::coordTensor)[coords]; id >= ModuleIdManager::MinStaticID()) {
                 std::cout << "#";
-            } else if (Lattice::coordTensor.GetArrayInternal()[i % Lattice::coordTensor.GetArrayInternal().size()] == OUT_OF_BOUNDS) {
+            } else if (id == OUT_OF_BOUNDS) {
                 std::cout << "⋅";
             } else {
                 std::cout << "+";
@@ -465,10 +495,11 @@ MoveOffsetPropertyHeuristicCache::MoveOffsetPropertyHeuristicCache(const std::se
         }
     }
     std::cout << std::endl;
+#endif
 }
 
-float MoveOffsetPropertyHeuristicCache::operator[](const std::valarray<int> &coords, std::uint_fast64_t propInt) const {
-    static std::valarray<int> coordProps(Lattice::Order() + 1, 0);
+float MoveOffsetPropertyHeuristicCache::operator[](const LatticeCoord& coords, std::uint_fast64_t propInt) const {
+    Coord<COORD_MAX_ORDER + 1> coordProps;
     for (int i = 0; i < Lattice::Order(); i++) {
         coordProps[i] = coords[i];
     }
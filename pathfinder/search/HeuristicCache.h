@@ -1,8 +1,8 @@
 #ifndef HEURISTICCACHE_H
 #define HEURISTICCACHE_H
 #include <queue>
-#include <valarray>
 #include <set>
+#include <vector>
 
 #include "../coordtensor/CoordTensor.h"
 #include "../modules/ModuleManager.h"
@@ -21,13 +21,17 @@
  * taking into account the amount of non-static modules that a module may interact with
  */
 #define CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS true
+/* Heuristic Cache Print Configuration
+ * When set to true, heuristic caches print their contents to stdout once they are built
+ */
+#define CONFIG_HEURISTIC_CACHE_PRINT false
 #if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS && !CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
 #warning "Help limitations disabled due to lack of distance limitations!"
 #define CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS false
 #endif
 
 struct SearchCoord {
-    std::valarray<int> coords;
+    LatticeCoord coords;
     float depth;
 };
 
@@ -37,7 +41,7 @@ protected:
 public:
     IHeuristicCache();
 
-    virtual float operator[](const std::valarray<int>& coords) const;
+    virtual float operator[](const LatticeCoord& coords) const;
 
     virtual ~IHeuristicCache() = default;
 };
@@ -59,23 +63,24 @@ public:
     explicit MoveOffsetHeuristicCache(const std::set<ModuleData>& desiredState);
 };
 
-struct SearchCoordProp final : public SearchCoord {
-    std::uint_fast64_t propInt{};
-};
-
 // This cache ONLY works if all module properties remain the same throughout the search
 class MoveOffsetPropertyHeuristicCache final : public IHeuristicCache {
 private:
-#if CONFIG_HEURISTIC_CACHE_HELP_LIMITATIONS
-    static int currentHelp;
-#endif
     static std::unordered_map<std::uint_fast64_t, int> propConversionMap;
 
-    static void MoveOffsetPropertyEnqueueAdjacent(std::queue<SearchCoordProp>& coordPropQueue, const SearchCoordProp& coordPropInfo);
+#if CONFIG_HEURISTIC_CACHE_DIST_LIMITATIONS
+    // Built on first use, which may mark unreachable cells of the lattice as out of bounds
+    static const CoordTensor<int>& InternalDistanceCache();
+#endif
+
+    // Breadth-first search over move offsets from every source at once, visit is called once for each reachable cell
+    // with its depth. Only reads the lattice, so searches can run in parallel.
+    template<typename F>
+    static void MoveOffsetPropertySearch(const std::vector<LatticeCoord>& sources, int help, F&& visit);
 public:
     explicit MoveOffsetPropertyHeuristicCache(const std::set<ModuleData>& desiredState);
 
-    float operator[](const std::valarray<int>& coords, std::uint_fast64_t propInt) const;
+    float operator[](const LatticeCoord& coords, std::uint_fast64_t propInt) const;
 };
 
 #endif //HEURISTICCACHE_H
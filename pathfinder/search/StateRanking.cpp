@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include "../lattice/Lattice.h"
+#include "StateRanking.h"
+
+constexpr std::uint64_t RANK_SATURATED = std::numeric_limits<std::uint64_t>::max();
+
+StateRanker::StateRanker() : cellIndices(Lattice::AxisSizes(), -1) {
+    moduleCount = ModuleIdManager::MinStaticID();
+    // Index every cell a non-static module could occupy
+    for (int i = 0; i < Lattice::coordTensor.Size(); i++) {
+        if (Lattice::coordTensor.IsPadding(i)) continue;
+        if (const auto id = std::as_const(Lattice::coordTensor).GetElementDirect(i); id == FREE_SPACE || (id >= 0 && id < moduleCount)) {
+            const auto coords = Lattice::coordTensor.CoordsFromIndex(i);
+            cellIndices[coords] = static_cast<int>(cellCoords.size());
+            cellCoords.push_back(coords);
+        }
+    }
+    const int cellCount = static_cast<int>(cellCoords.size());
+    // Pascal's triangle, saturating on overflow
+    binomials.resize(cellCount + 1, std::vector<std::uint64_t>(moduleCount + 1, 0));
+    for (int n = 0; n <= cellCount; n++) {
+        binomials[n][0] = 1;
+        for (int k = 1; k <= std::min(n, moduleCount); k++) {
+            const auto a = binomials[n - 1][k - 1], b = k <= n - 1 ? binomials[n - 1][k] : 0;
+            binomials[n][k] = (a > RANK_SATURATED - b) ? RANK_SATURATED : a + b;
+        }
+    }
+    // Determine property classes, ranking relies on the property multiset never changing so modules with properties
+    // that can change as they move are not supported
+    for (const auto& mod : ModuleIdManager::FreeModules()) {
+        if (!Lattice::ignoreProperties && mod.properties.HasDynamicProperties()) {
+            supported = false;
+            return;
+        }
+        const auto propInt = Lattice::ignoreProperties ? 0 : mod.properties.AsInt();
+        if (const int propClass = PropertyClass(propInt); propClass != -1) {
+            classCounts[propClass]++;
+            continue;
+        }
+        classInts.push_back(propInt);
+        classProperties.push_back(mod.properties);
+        classCounts.push_back(1);
+    }
+    // colorings = moduleCount! / (count_0! * count_1! * ...), built one module at a time to keep values exact
+    int placed = 0;
+    for (const auto count : classCounts) {
+        for (int i = 1; i <= count; i++) {
+            placed++;
+            const auto product = static_cast<unsigned __int128>(colorings) * placed;
+            if (product / i > RANK_SATURATED) {
+                supported = false;
+                return;
+            }
+            colorings = static_cast<std::uint64_t>(product / i);
+        }
+    }
+    if (moduleCount > cellCount || binomials[cellCount][moduleCount] == RANK_SATURATED) {
+        supported = false;
+        return;
+    }
+    const auto total = static_cast<unsigned __int128>(binomials[cellCount][moduleCount]) * colorings;
+    if (total >= RANK_SATURATED) {
+        supported = false;
+        return;
+    }
+    stateCount = static_cast<std::uint64_t>(total);
+}
+
+int StateRanker::PropertyClass(const std::uint_fast64_t propInt) const {
+    for (int i = 0; i < classInts.size(); i++) {
+        if (classInts[i] == propInt) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool StateRanker::Supported() const {
+    return supported;
+}
+
+std::uint64_t StateRanker::StateCount() const {
+    return stateCount;
+}
+
+int StateRanker::CellCount() const {
+    return static_cast<int>(cellCoords.size());
+}
+
+std::uint64_t StateRanker::Rank(const std::set<ModuleData>& state) const {
+    // Pair up cell indices with property classes, ordered by cell index
+    std::vector<std::pair<int, int>> cells;
+    cells.reserve(moduleCount);
+    for (const auto& modData : state) {
+        cells.emplace_back(cellIndices[modData.Coords()],
+                           PropertyClass(Lattice::ignoreProperties ? 0 : modData.Properties().AsInt()));
+    }
+    std::ranges::sort(cells);
+    // Rank positions using the combinatorial number system
+    std::uint64_t positionRank = 0;
+    for (int i = 0; i < cells.size(); i++) {
+        positionRank += binomials[cells[i].first][i + 1];
+    }
+    // Rank property sequence as a multiset permutation
+    std::uint64_t colorRank = 0;
+    auto counts = classCounts;
+    unsigned __int128 remainingPerms = colorings;
+    for (int i = 0; i < cells.size(); i++) {
+        const int remaining = moduleCount - i;
+        for (int propClass = 0; propClass < cells[i].second; propClass++) {
+            colorRank += static_cast<std::uint64_t>(remainingPerms * counts[propClass] / remaining);
+        }
+        remainingPerms = remainingPerms * counts[cells[i].second] / remaining;
+        counts[cells[i].second]--;
+    }
+    return positionRank * colorings + colorRank;
+}
+
+std::set<ModuleData> StateRanker::Unrank(const std::uint64_t rank) const {
+    auto positionRank = rank / colorings;
+    auto colorRank = rank % colorings;
+    // Recover cell indices, largest first
+    std::vector<int> cells(moduleCount);
+    int cell = CellCount() - 1;
+    for (int i = moduleCount; i > 0; i--) {
+        while (binomials[cell][i] > positionRank) {
+            cell--;
+        }
+        cells[i - 1] = cell;
+        positionRank -= binomials[cell][i];
+        cell--;
+    }
+    // Recover property classes
+    std::set<ModuleData> state;
+    auto counts = classCounts;
+    unsigned __int128 remainingPerms = colorings;
+    for (int i = 0; i < moduleCount; i++) {
+        const int remaining = moduleCount - i;
+        int propClass = 0;
+        for (;; propClass++) {
+            const auto block = static_cast<std::uint64_t>(remainingPerms * counts[propClass] / remaining);
+            if (colorRank < block) break;
+            colorRank -= block;
+        }
+        remainingPerms = remainingPerms * counts[propClass] / remaining;
+        counts[propClass]--;
+        state.insert({cellCoords[cells[i]], classProperties[propClass]});
+    }
+    return state;
+}
+
+DenseVisitedSet::DenseVisitedSet(const std::uint64_t stateCount) : bits((stateCount + 63) / 64, 0) {}
+
+bool DenseVisitedSet::Insert(const std::uint64_t rank) {
+    auto& word = bits[rank / 64];
+    const auto bit = std::uint64_t{1} << (rank % 64);
+    if (word & bit) {
+        return false;
+    }
+    word |= bit;
+    count++;
+    return true;
+}
+
+bool DenseVisitedSet::Contains(const std::uint64_t rank) const {
+    return (bits[rank / 64] >> (rank % 64)) & 1;
+}
+
+std::size_t DenseVisitedSet::Size() const {
+    return count;
+}
+
+DenseDepthArray::DenseDepthArray(const std::uint64_t stateCount) : words((stateCount + 31) / 32, 0) {}
+
+std::uint8_t DenseDepthArray::Get(const std::uint64_t rank) const {
+    return (words[rank / 32] >> (2 * (rank % 32))) & 0b11;
+}
+
+void DenseDepthArray::Set(const std::uint64_t rank, const int depth) {
+    auto& word = words[rank / 32];
+    const auto shift = 2 * (rank % 32);
+    word = (word & ~(std::uint64_t{0b11} << shift)) | (static_cast<std::uint64_t>(Encode(depth)) << shift);
+}
+
+std::uint8_t DenseDepthArray::Encode(const int depth) {
+    return depth % 3 + 1;
+}
@@ -0,0 +1,108 @@
+#ifndef MODULAR_ROBOTICS_STATERANKING_H
+#define MODULAR_ROBOTICS_STATERANKING_H
+
+#include <cstdint>
+#include <set>
+#include <vector>
+#include "../coordtensor/CoordTensor.h"
+#include "../modules/ModuleManager.h"
+
+// Perfect ranking of non-static module configurations within a bounded region. A configuration of n non-static
+// modules is ranked into [0, C(cells, n) * colorings) using the combinatorial number system for module positions and
+// multiset permutation ranking for module properties, where cells is the number of cells a non-static module could
+// occupy and colorings is the number of distinct ways to assign the property multiset to n positions. Only supported
+// when properties are ignored or can't change as modules move, otherwise the property multiset could drift.
+class StateRanker {
+private:
+    // Set to false if the state count doesn't fit within 64 bits or module properties may change
+    bool supported = true;
+    // # of non-static modules
+    int moduleCount = 0;
+    // Total number of states that can be ranked
+    std::uint64_t stateCount = 0;
+    // Number of distinct property assignments
+    std::uint64_t colorings = 1;
+    // Maps lattice coordinates to free cell index, -1 for cells that can't hold a non-static module
+    CoordTensor<int> cellIndices;
+    // Maps free cell index back to lattice coordinates
+    std::vector<LatticeCoord> cellCoords;
+    // binomials[n][k] = n choose k, saturated at UINT64_MAX
+    std::vector<std::vector<std::uint64_t>> binomials;
+    // One representative set of properties per property class
+    std::vector<ModuleProperties> classProperties;
+    // Integer representation of each property class
+    std::vector<std::uint_fast64_t> classInts;
+    // # of modules with each property class
+    std::vector<int> classCounts;
+
+    [[nodiscard]]
+    int PropertyClass(std::uint_fast64_t propInt) const;
+
+public:
+    // Build ranker using the current lattice, every cell that is not out of bounds and not occupied by a static module
+    // is considered free
+    StateRanker();
+
+    // Check if every reachable state can be represented by a 64-bit rank
+    [[nodiscard]]
+    bool Supported() const;
+
+    // Number of possible states
+    [[nodiscard]]
+    std::uint64_t StateCount() const;
+
+    // Number of cells that non-static modules may occupy
+    [[nodiscard]]
+    int CellCount() const;
+
+    [[nodiscard]]
+    std::uint64_t Rank(const std::set<ModuleData>& state) const;
+
+    [[nodiscard]]
+    std::set<ModuleData> Unrank(std::uint64_t rank) const;
+};
+
+// Visited set indexed by state rank, holds exactly one bit per possible state
+class DenseVisitedSet {
+private:
+    std::vector<std::uint64_t> bits;
+    std::size_t count = 0;
+public:
+    DenseVisitedSet() = default;
+
+    explicit DenseVisitedSet(std::uint64_t stateCount);
+
+    // Mark a rank as visited, returns false if it was already visited
+    bool Insert(std::uint64_t rank);
+
+    [[nodiscard]]
+    bool Contains(std::uint64_t rank) const;
+
+    [[nodiscard]]
+    std::size_t Size() const;
+};
+
+// Depth array indexed by state rank, holds two bits per possible state. Depths are stored modulo 3 so that a
+// breadth-first search can tell the previous, current and next layer apart, 0 is reserved for unvisited states.
+class DenseDepthArray {
+private:
+    std::vector<std::uint64_t> words;
+public:
+    static constexpr std::uint8_t UNVISITED = 0;
+
+    DenseDepthArray() = default;
+
+    explicit DenseDepthArray(std::uint64_t stateCount);
+
+    // Get depth mod 3 + 1 of a state, or UNVISITED
+    [[nodiscard]]
+    std::uint8_t Get(std::uint64_t rank) const;
+
+    // Record depth of a state
+    void Set(std::uint64_t rank, int depth);
+
+    // Convert a depth into the value stored by Set
+    static std::uint8_t Encode(int depth);
+};
+
+#endif //MODULAR_ROBOTICS_STATERANKING_H
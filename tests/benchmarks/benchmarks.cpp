@@ -26,7 +26,7 @@ int main() {
     LatticeSetup::setupFromJson(fileStart);
     MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
     MoveManager::RegisterAllMoves();
-    Configuration start(Lattice::stateTensor, Lattice::colorTensor);
+    Configuration start(Lattice::GetModuleInfo());
     Configuration end = LatticeSetup::setupFinalFromJson(fileEnd);
 
     // Benchmark the BFS function
@@ -0,0 +1,98 @@
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "CoordTensor.h"
+#include "Lattice.h"
+#include "LatticeSetup.h"
+#include "MoveManager.h"
+
+// Compares linear and Morton tensor layouts on neighborhood-heavy kernels. The scenario to load can be passed as the
+// only argument, run once with docs/examples/moves/3d_move_gauntlet and once with docs/examples/moves/rd_superrigid.
+// A synthetic lattice is also benchmarked, since the example lattices are small enough to fit in L1 cache entirely.
+constexpr int SYNTHETIC_AXIS_SIZE = 256;
+constexpr int SYNTHETIC_MODULES = 1 << 16;
+
+// Face neighbors followed by rhombic dodecahedron neighbors
+const std::vector<LatticeCoord> NEIGHBOR_OFFSETS = {
+    {-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1},
+    {-1, -1, 0}, {1, -1, 0}, {-1, 1, 0}, {1, 1, 0},
+    {-1, 0, -1}, {1, 0, -1}, {-1, 0, 1}, {1, 0, 1},
+    {0, -1, -1}, {0, 1, -1}, {0, -1, 1}, {0, 1, 1}
+};
+
+CoordTensor<int> CopyLattice(const TensorLayout layout) {
+    CoordTensor<int> tensor(Lattice::Order(), Lattice::AxisSize(), OUT_OF_BOUNDS, {}, TENSOR_DENSE, layout);
+    for (int i = 0; i < Lattice::coordTensor.Size(); i++) {
+        const auto coords = Lattice::coordTensor.CoordsFromIndex(i);
+        tensor[coords] = Lattice::coordTensor.GetElementDirect(i);
+    }
+    return tensor;
+}
+
+int NeighborSum(const CoordTensor<int>& tensor, const std::vector<LatticeCoord>& positions) {
+    int sum = 0;
+    for (const auto& position : positions) {
+        for (const auto& offset : NEIGHBOR_OFFSETS) {
+            sum += tensor[position + offset];
+        }
+    }
+    return sum;
+}
+
+void BenchScenario(ankerl::nanobench::Bench& bench, const std::string& scenario) {
+    LatticeSetup::setupFromJson(scenario);
+    MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
+    MoveManager::RegisterAllMoves();
+    std::vector<LatticeCoord> positions;
+    for (const auto& mod : ModuleIdManager::Modules()) {
+        positions.push_back(mod.coords);
+    }
+    for (const auto layout : {TENSOR_LINEAR, TENSOR_MORTON}) {
+        auto tensor = CopyLattice(layout);
+        const std::string layoutName = layout == TENSOR_LINEAR ? "linear" : "Morton";
+        bench.batch(positions.size() * NEIGHBOR_OFFSETS.size()).unit("probe");
+        bench.run(scenario + ", neighbor probes, " + layoutName, [&]() {
+            ankerl::nanobench::doNotOptimizeAway(NeighborSum(tensor, positions));
+        });
+        bench.batch(ModuleIdManager::FreeModules().size()).unit("module");
+        bench.run(scenario + ", move checks, " + layoutName, [&]() {
+            for (auto& mod : ModuleIdManager::FreeModules()) {
+                ankerl::nanobench::doNotOptimizeAway(MoveManager::CheckAllMoves(tensor, mod));
+            }
+        });
+    }
+}
+
+void BenchSynthetic(ankerl::nanobench::Bench& bench) {
+    std::mt19937 rng(SYNTHETIC_MODULES);
+    std::uniform_int_distribution<int> dist(1, SYNTHETIC_AXIS_SIZE - 2);
+    std::vector<LatticeCoord> positions;
+    for (int i = 0; i < SYNTHETIC_MODULES; i++) {
+        positions.push_back({dist(rng), dist(rng), dist(rng)});
+    }
+    // Visit modules in a spatially coherent order, as a search expanding neighboring states would
+    std::ranges::sort(positions);
+    for (const auto layout : {TENSOR_LINEAR, TENSOR_MORTON}) {
+        CoordTensor<int> tensor(3, SYNTHETIC_AXIS_SIZE, FREE_SPACE, {}, TENSOR_DENSE, layout);
+        for (int i = 0; i < positions.size(); i++) {
+            tensor[positions[i]] = i;
+        }
+        const std::string layoutName = layout == TENSOR_LINEAR ? "linear" : "Morton";
+        bench.batch(positions.size() * NEIGHBOR_OFFSETS.size()).unit("probe");
+        bench.run("Synthetic " + std::to_string(SYNTHETIC_AXIS_SIZE) + "^3, neighbor probes, " + layoutName, [&]() {
+            ankerl::nanobench::doNotOptimizeAway(NeighborSum(tensor, positions));
+        });
+    }
+}
+
+int main(const int argc, char* argv[]) {
+    ankerl::nanobench::Bench bench;
+    bench.title("Tensor Layout").minEpochIterations(10);
+    const std::string scenario = argc > 1 ? argv[1] : "docs/examples/moves/3d_move_gauntlet/3d_move_gauntlet_initial.json";
+    BenchScenario(bench, scenario);
+    BenchSynthetic(bench);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "ConcurrentVisitedSet.h"
+
+// Contention benchmark for concurrent visited sets. Every thread inserts keys drawn from a shared key space so that a
+// large fraction of insertions are duplicates of keys inserted by other threads, as happens during a parallel search.
+constexpr std::size_t INSERTS_PER_THREAD = 1 << 16;
+constexpr std::uint64_t KEY_SPACE = 1 << 18;
+
+std::vector<std::vector<std::uint64_t>> MakeKeys(const int threadCount) {
+    std::vector<std::vector<std::uint64_t>> keys(threadCount);
+    std::mt19937_64 rng(threadCount);
+    std::uniform_int_distribution<std::uint64_t> dist(1, KEY_SPACE);
+    for (auto& threadKeys : keys) {
+        threadKeys.resize(INSERTS_PER_THREAD);
+        for (auto& key : threadKeys) {
+            key = dist(rng);
+        }
+    }
+    return keys;
+}
+
+template<typename InsertFunc>
+void RunThreads(const std::vector<std::vector<std::uint64_t>>& keys, InsertFunc insert) {
+    std::vector<std::thread> threads;
+    threads.reserve(keys.size());
+    for (const auto& threadKeys : keys) {
+        threads.emplace_back([&threadKeys, &insert]() {
+            for (const auto key : threadKeys) {
+                insert(key);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+int main() {
+    ankerl::nanobench::Bench bench;
+    bench.title("Visited Set Contention").unit("insert").minEpochIterations(3);
+    for (int threadCount = 1; threadCount <= 64; threadCount *= 2) {
+        const auto keys = MakeKeys(threadCount);
+        std::unordered_set<std::uint64_t> expected;
+        for (const auto& threadKeys : keys) {
+            expected.insert(threadKeys.begin(), threadKeys.end());
+        }
+        bench.batch(INSERTS_PER_THREAD * threadCount);
+
+        bench.run("Lock-free, " + std::to_string(threadCount) + " threads", [&]() {
+            ConcurrentVisitedSet visited;
+            std::atomic<std::size_t> inserted = 0;
+            RunThreads(keys, [&](const std::uint64_t key) {
+                if (visited.Insert(key)) {
+                    inserted.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            if (inserted != expected.size() || visited.Size() != expected.size()) {
+                std::cerr << "Lock-free visited set inserted " << inserted << " keys, expected " << expected.size()
+                          << std::endl;
+                std::exit(1);
+            }
+            ankerl::nanobench::doNotOptimizeAway(visited);
+        });
+
+        bench.run("Mutex, " + std::to_string(threadCount) + " threads", [&]() {
+            std::unordered_set<std::uint64_t> visited;
+            std::mutex visitedMutex;
+            RunThreads(keys, [&](const std::uint64_t key) {
+                std::lock_guard lock(visitedMutex);
+                visited.insert(key);
+            });
+            ankerl::nanobench::doNotOptimizeAway(visited);
+        });
+    }
+    return 0;
+}
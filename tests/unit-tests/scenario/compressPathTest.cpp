@@ -0,0 +1,86 @@
+#define BOOST_TEST_MODULE CompressPathTest
+#include <boost/test/included/unit_test.hpp>
+#include <ranges>
+#include <string>
+#include <vector>
+#include "../../../pathfinder/lattice/LatticeSetup.h"
+#include "../../../pathfinder/moves/Scenario.h"
+#include "../../../pathfinder/moves/MoveManager.h"
+#include "../../../pathfinder/search/ConfigurationSpace.h"
+#include <boost/test/tools/interface.hpp>
+
+// set --log_level=all to see boost output
+
+struct TestFixture {
+    std::string fileS;
+    std::string fileF;
+
+    TestFixture() {
+        fileS = "../docs/examples/moves/flip_3d_line/flip_3d_line_initial.json";
+        fileF = "../docs/examples/moves/flip_3d_line/flip_3d_line_final.json";
+    }
+};
+
+// Check whether a step changes a cell another step reads
+bool WritesInto(const Transition& writer, const Transition& reader) {
+    if (writer.from == reader.from || writer.to == reader.from) return true;
+    for (const auto& offset : MoveManager::GetMove(reader.moveId)->SortedChecks() | std::views::keys) {
+        if (writer.from == reader.from + offset || writer.to == reader.from + offset) return true;
+    }
+    return false;
+}
+
+void MoveBlock(const std::vector<Transition>& block) {
+    std::vector<Module*> modules;
+    for (const auto& step : block) {
+        modules.push_back(&ModuleIdManager::GetModule(Lattice::coordTensor[step.from]));
+    }
+    for (int i = 0; i < block.size(); i++) {
+        Lattice::MoveModule(*modules[i], block[i].to - block[i].from);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(InitTest, TestFixture) {
+    ModuleProperties::LinkProperties();
+    Lattice::setFlags(false);
+    LatticeSetup::setupFromJson(fileS);
+    MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
+    MoveManager::RegisterAllMoves("../Moves");
+}
+
+BOOST_FIXTURE_TEST_CASE(TestCompressedPathInvariants, TestFixture) {
+    Configuration start(Lattice::GetModuleInfo());
+    Configuration end = LatticeSetup::setupFinalFromJson(fileF);
+    const auto path = ConfigurationSpace::BFS(&start, &end);
+    BOOST_REQUIRE_GT(path.size(), 1);
+    const auto blocks = Scenario::CompressPath(path);
+    BOOST_REQUIRE(!blocks.empty());
+    std::size_t stepCount = 0;
+    for (const auto& block : blocks) {
+        stepCount += block.size();
+    }
+    BOOST_CHECK_EQUAL(stepCount, path.size() - 1);
+    BOOST_CHECK_LE(blocks.size(), path.size() - 1);
+    Lattice::UpdateFromModuleInfo(path.front()->GetModData());
+    for (const auto& block : blocks) {
+        BOOST_REQUIRE(!block.empty());
+        // Dependent steps never share a block
+        for (int i = 0; i < block.size(); i++) {
+            for (int j = i + 1; j < block.size(); j++) {
+                BOOST_CHECK(!WritesInto(block[i], block[j]) && !WritesInto(block[j], block[i]));
+            }
+        }
+        // The rest of the lattice stays connected while the block's modules are detached, and after they land
+        std::vector<Module*> detached;
+        for (const auto& step : block) {
+            BOOST_REQUIRE_GE(Lattice::coordTensor[step.from], 0);
+            detached.push_back(&ModuleIdManager::GetModule(Lattice::coordTensor[step.from]));
+        }
+        BOOST_CHECK(Lattice::checkConnected(detached));
+        MoveBlock(block);
+        BOOST_CHECK(Lattice::checkConnected());
+    }
+    // Replaying every block reaches the end of the path
+    BOOST_CHECK(Lattice::GetModuleInfo() == path.back()->GetModData());
+    Isometry::CleanupTransforms();
+}
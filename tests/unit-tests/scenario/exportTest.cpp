@@ -0,0 +1,131 @@
+#define BOOST_TEST_MODULE ExportTest
+#include <boost/test/included/unit_test.hpp>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../../../pathfinder/lattice/LatticeSetup.h"
+#include "../../../pathfinder/moves/Scenario.h"
+#include "../../../pathfinder/moves/MoveManager.h"
+#include "../../../pathfinder/search/ConfigurationSpace.h"
+#include <boost/test/tools/interface.hpp>
+
+// set --log_level=all to see boost output
+
+struct TestFixture {
+    std::string fileS;
+    std::string fileF;
+    std::string scenFile;
+    std::string planFile;
+
+    TestFixture() {
+        fileS = "../docs/examples/moves/flip_3d_line/flip_3d_line_initial.json";
+        fileF = "../docs/examples/moves/flip_3d_line/flip_3d_line_final.json";
+        scenFile = (std::filesystem::temp_directory_path() / "export_test.scen").string();
+        planFile = (std::filesystem::temp_directory_path() / "export_test.plan").string();
+    }
+};
+
+// Split a scenario file into its sections, each section is a list of lines with comma separated integers. Sections
+// after the header, palette and module definitions are checkpoints.
+std::vector<std::vector<std::vector<int>>> ReadScenSections(const std::string& scenFile) {
+    std::ifstream file(scenFile);
+    std::vector<std::vector<std::vector<int>>> sections(1);
+    std::string line;
+    for (int i = 0; i < 3; i++) {
+        std::getline(file, line);
+    }
+    while (std::getline(file, line)) {
+        if (line.empty()) {
+            if (!sections.back().empty()) {
+                sections.emplace_back();
+            }
+            continue;
+        }
+        std::vector<int> values;
+        std::stringstream stream(line);
+        for (std::string value; std::getline(stream, value, ',');) {
+            values.push_back(std::stoi(value));
+        }
+        sections.back().push_back(values);
+    }
+    if (sections.back().empty()) {
+        sections.pop_back();
+    }
+    return sections;
+}
+
+std::vector<std::int32_t> ReadPlanWords(const std::string& planFile) {
+    std::ifstream file(planFile, std::ios::binary);
+    std::vector<std::int32_t> words;
+    for (std::int32_t word; file.read(reinterpret_cast<char*>(&word), sizeof(word));) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+BOOST_FIXTURE_TEST_CASE(InitTest, TestFixture) {
+    ModuleProperties::LinkProperties();
+    Lattice::setFlags(false);
+    LatticeSetup::setupFromJson(fileS);
+    MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
+    MoveManager::RegisterAllMoves("../Moves");
+}
+
+BOOST_FIXTURE_TEST_CASE(TestPlanMatchesScen, TestFixture) {
+    Configuration start(Lattice::GetModuleInfo());
+    Configuration end = LatticeSetup::setupFinalFromJson(fileF);
+    const auto path = ConfigurationSpace::AStar(&start, &end);
+    BOOST_REQUIRE_GT(path.size(), 1);
+    Scenario::ScenInfo scenInfo;
+    scenInfo.exportFile = scenFile;
+    scenInfo.scenName = "export_test";
+    scenInfo.scenDesc = "Export test";
+    scenInfo.planFile = planFile;
+    Scenario::exportToScen(path, scenInfo);
+
+    const auto sections = ReadScenSections(scenFile);
+    const auto words = ReadPlanWords(planFile);
+    BOOST_REQUIRE_GE(words.size(), 3);
+    const int stepCount = words[2];
+    BOOST_REQUIRE_EQUAL(stepCount, path.size() - 1);
+    BOOST_REQUIRE_EQUAL(words.size(), 3 + 5 * stepCount);
+    // Palette and module definitions, then one checkpoint per step
+    BOOST_REQUIRE_EQUAL(sections.size(), 2 + stepCount);
+    std::map<int, std::array<int, 3>> positions;
+    for (const auto& modDef : sections[1]) {
+        positions[modDef[0]] = {modDef[2], modDef[3], modDef[4]};
+    }
+    for (int i = 0; i < stepCount; i++) {
+        const auto* step = &words[3 + 5 * i];
+        // Every line of the checkpoint belongs to the module the plan moves
+        for (const auto& moveLine : sections[2 + i]) {
+            BOOST_CHECK_EQUAL(moveLine[0], step[0]);
+        }
+        BOOST_REQUIRE(positions.contains(step[0]));
+        for (int axis = 0; axis < 3; axis++) {
+            positions[step[0]][axis] += step[2 + axis];
+        }
+    }
+    // Moving the modules of the scenario file by the plan reaches the end of the path, static modules aren't part of
+    // the configurations
+    std::set<std::array<int, 3>> reached, expected;
+    for (const auto& [id, coords] : positions) {
+        if (id < ModuleIdManager::MinStaticID()) {
+            reached.insert(coords);
+        }
+    }
+    for (const auto& modData : path.back()->GetModData()) {
+        const auto coords = modData.Coords() + Lattice::cropOrigin;
+        expected.insert({coords[0], coords[1], coords[2]});
+    }
+    BOOST_CHECK(reached == expected);
+    std::filesystem::remove(scenFile);
+    std::filesystem::remove(planFile);
+    Isometry::CleanupTransforms();
+}
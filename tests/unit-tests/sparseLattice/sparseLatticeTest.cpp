@@ -0,0 +1,42 @@
+#define BOOST_TEST_MODULE SparseLatticeTest
+#include <boost/test/included/unit_test.hpp>
+#include <string>
+#include "../../../pathfinder/lattice/LatticeSetup.h"
+#include "../../../pathfinder/moves/MoveManager.h"
+#include "../../../pathfinder/search/ConfigurationSpace.h"
+#include <boost/test/tools/interface.hpp>
+
+// set --log_level=all to see boost output
+
+// Same modules as flip_3d_line, on a lattice large enough to use sparse storage
+struct TestFixture {
+    std::string fileS;
+    std::string fileF;
+
+    TestFixture() {
+        fileS = "../docs/examples/moves/flip_3d_line_sparse/flip_3d_line_sparse_initial.json";
+        fileF = "../docs/examples/moves/flip_3d_line_sparse/flip_3d_line_sparse_final.json";
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(InitTest, TestFixture) {
+    ModuleProperties::LinkProperties();
+    Lattice::setFlags(false);
+    LatticeSetup::setupFromJson(fileS);
+    MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
+    MoveManager::RegisterAllMoves("../Moves");
+    BOOST_CHECK_EQUAL(Lattice::coordTensor.Storage(), TENSOR_SPARSE);
+}
+
+BOOST_FIXTURE_TEST_CASE(TestSparseSearch, TestFixture) {
+    Configuration start(Lattice::GetModuleInfo());
+    Configuration end = LatticeSetup::setupFinalFromJson(fileF);
+    const auto bfsPath = ConfigurationSpace::BFS(&start, &end);
+    // flip_3d_line takes 12 moves on a dense lattice
+    BOOST_REQUIRE_EQUAL(bfsPath.size(), 13);
+    BOOST_CHECK(bfsPath.back()->GetHash() == end.GetHash());
+    Configuration aStarStart(bfsPath.front()->GetModData());
+    const auto aStarPath = ConfigurationSpace::AStar(&aStarStart, &end);
+    BOOST_CHECK_EQUAL(aStarPath.size(), bfsPath.size());
+    Isometry::CleanupTransforms();
+}
@@ -0,0 +1,41 @@
+#define BOOST_TEST_MODULE StateRankingTest
+#include <boost/test/included/unit_test.hpp>
+#include <set>
+#include <string>
+#include "../../../pathfinder/lattice/LatticeSetup.h"
+#include "../../../pathfinder/moves/MoveManager.h"
+#include "../../../pathfinder/search/StateRanking.h"
+#include <boost/test/tools/interface.hpp>
+
+// set --log_level=all to see boost output
+
+struct TestFixture {
+    std::string fileS;
+
+    TestFixture() {
+        fileS = "../docs/examples/moves/move_line_with_colors/move_line_with_colors_initial.json";
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(InitTest, TestFixture) {
+    ModuleProperties::LinkProperties();
+    Lattice::setFlags(false);
+    LatticeSetup::setupFromJson(fileS);
+    MoveManager::InitMoveManager(Lattice::Order(), Lattice::AxisSize());
+    MoveManager::RegisterAllMoves("../Moves");
+}
+
+BOOST_FIXTURE_TEST_CASE(TestRankUnrankRoundTrip, TestFixture) {
+    const StateRanker ranker;
+    BOOST_REQUIRE(ranker.Supported());
+    BOOST_REQUIRE_GT(ranker.StateCount(), 0);
+    // Every rank maps to a distinct state that ranks back to itself
+    for (std::uint64_t rank = 0; rank < ranker.StateCount(); rank++) {
+        BOOST_CHECK_EQUAL(ranker.Rank(ranker.Unrank(rank)), rank);
+    }
+    // The current lattice state survives ranking and unranking
+    const auto state = Lattice::GetModuleInfo();
+    const auto rank = ranker.Rank(state);
+    BOOST_CHECK_LT(rank, ranker.StateCount());
+    BOOST_CHECK(ranker.Unrank(rank) == state);
+}